@@ -0,0 +1,299 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "analysis.h"
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+#include "thread.h"
+#include "time.h"
+#include "types.h"
+#include "uci.h"
+#include "writer.h"
+
+
+static const char SANPieces[] = "PNBRQK";
+
+static volatile int AnalysisStopped; // Set by the UCI thread
+
+extern volatile int ABORT_SIGNAL; // Defined by Search.c
+
+int readPGNGame(FILE *fin, char *fen, char *result, char *moves, int size) {
+
+    int c, length = 0, depth = 0, content = 0;
+    char tag[8192], *ptr;
+
+    strcpy(fen, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    result[0] = '\0';
+
+    while ((c = fgetc(fin)) != EOF) {
+
+        // Tag pairs, where only the starting position and the result are of
+        // interest. Tags after any movetext belong to the next game, so hand
+        // the bracket back for the next call to find
+        if (c == '[' && depth == 0) {
+            if (content) { ungetc(c, fin); break; }
+            if (fgets(tag, sizeof(tag), fin) == NULL) break;
+            if (!strncmp(tag, "FEN \"", 5) && (ptr = strchr(tag + 5, '"')) != NULL)
+                *ptr = '\0', strcpy(fen, tag + 5);
+            if (!strncmp(tag, "Result \"", 8) && (ptr = strchr(tag + 8, '"')) != NULL && ptr - tag < 16)
+                *ptr = '\0', strcpy(result, tag + 8);
+            continue;
+        }
+
+        // Skip over comments, and over variations which may be nested
+        if (c == '{') { while ((c = fgetc(fin)) != EOF && c != '}'); continue; }
+        if (c == ';') { while ((c = fgetc(fin)) != EOF && c != '\n'); continue; }
+        if (c == '(') { depth++; continue; }
+        if (c == ')') { depth = depth > 0 ? depth - 1 : 0; continue; }
+
+        if (depth == 0 && length + 2 < size) {
+            if (c == '\n' || c == '\r' || c == '\t') c = ' ';
+            content |= c > ' ';
+            moves[length++] = (char)c;
+        }
+    }
+
+    moves[length] = '\0';
+    return content;
+}
+
+void moveToSAN(Board *board, uint16_t move, char *str) {
+
+    int size = 0, length = 0, file = 0, rank = 0;
+    uint16_t moves[MAX_MOVES];
+
+    const int from = MoveFrom(move), to = MoveTo(move);
+    const int piece = pieceType(board->squares[from]);
+
+    if (MoveType(move) == CASTLE_MOVE) {
+        strcpy(str, to > from ? "O-O" : "O-O-O");
+        return;
+    }
+
+    // Other pieces of the same type which could also reach the destination
+    genAllLegalMoves(board, moves, &size);
+    for (int i = 0; i < size && piece != PAWN; i++) {
+        if (   moves[i] == move
+            || MoveTo(moves[i]) != to
+            || pieceType(board->squares[MoveFrom(moves[i])]) != piece)
+            continue;
+        file |= MoveFrom(moves[i]) % 8 == from % 8;
+        rank |= MoveFrom(moves[i]) / 8 == from / 8;
+        rank |= 2; // Another piece at all, which needs some disambiguation
+    }
+
+    if (piece != PAWN) str[length++] = SANPieces[piece];
+
+    // Prefer the file, then the rank, and finally the full square
+    if (rank & 2) {
+        if (!(file & 1)) str[length++] = 'a' + from % 8;
+        else if (!(rank & 1)) str[length++] = '1' + from / 8;
+        else str[length++] = 'a' + from % 8, str[length++] = '1' + from / 8;
+    }
+
+    // Captures, where pawns always give their file
+    if (board->squares[to] != EMPTY || MoveType(move) == ENPASS_MOVE) {
+        if (piece == PAWN) str[length++] = 'a' + from % 8;
+        str[length++] = 'x';
+    }
+
+    str[length++] = 'a' + to % 8;
+    str[length++] = '1' + to / 8;
+
+    if (MoveType(move) == PROMOTION_MOVE)
+        str[length++] = '=', str[length++] = SANPieces[MovePromoPiece(move)];
+
+    str[length] = '\0';
+}
+
+uint16_t parseGameMove(Board *board, char *token) {
+
+    int size = 0, length = 0;
+    uint16_t moves[MAX_MOVES];
+    char clean[16], uci[6], san[8];
+
+    // Drop check marks, annotations and promotion signs, and accept zeros
+    // for castling, so that SAN from most sources compares as our own
+    for (char *ptr = token; *ptr && length < 15; ptr++) {
+        if (strchr("+#!?=", *ptr)) continue;
+        clean[length++] = *ptr == '0' ? 'O' : *ptr;
+    }
+    clean[length] = '\0';
+
+    genAllLegalMoves(board, moves, &size);
+
+    for (int i = 0; i < size; i++) {
+
+        moveToString(moves[i], uci);
+        moveToSAN(board, moves[i], san);
+
+        // Remove the promotion sign from our own SAN as well
+        if ((length = strlen(san)) > 2 && san[length-2] == '=')
+            san[length-2] = san[length-1], san[length-1] = '\0';
+
+        if (stringEquals(token, uci) || stringEquals(clean, san))
+            return moves[i];
+    }
+
+    return NONE_MOVE;
+}
+
+void resetGameAnalysis() {
+    AnalysisStopped = 0;
+}
+
+void stopGameAnalysis() {
+    AnalysisStopped = 1;
+    ABORT_SIGNAL = 1;
+}
+
+void runGameAnalysis(Thread *threads, char *str) {
+
+    static Board boards[ANALYSIS_MAX_PLIES + 1];
+    static char pgn[65536];
+
+    Limits limits;
+    Undo undo;
+    double start;
+    uint64_t nodes = 0ull;
+    char fen[256], result[16], bestStr[6], playedStr[6], *ptr, *moves = NULL;
+    FILE *fin;
+    int plies = 0, first, size, value, values[ANALYSIS_MAX_PLIES + 1];
+    uint16_t ponder, legal[MAX_MOVES], played[ANALYSIS_MAX_PLIES], bests[ANALYSIS_MAX_PLIES + 1];
+
+    // Search each position to a fixed depth, unless given another limit
+    memset(&limits, 0, sizeof(Limits));
+    limits.limitedByDepth = 1;
+    limits.depthLimit     = ANALYSIS_DEPTH;
+
+    if ((ptr = strstr(str, "depth ")) != NULL)
+        limits.depthLimit = atoi(ptr + strlen("depth "));
+
+    if ((ptr = strstr(str, "movetime ")) != NULL) {
+        limits.limitedByDepth = 0;
+        limits.limitedByTime  = 1;
+        limits.timeLimit      = atoi(ptr + strlen("movetime "));
+    }
+
+    // The game is either a PGN file, or a position followed by moves
+    strcpy(fen, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+    if ((ptr = strstr(str, "pgn ")) != NULL) {
+        pgn[0] = '\0';
+        if ((fin = fopen(ptr + strlen("pgn "), "r")) != NULL) {
+            readPGNGame(fin, fen, result, pgn, sizeof(pgn));
+            fclose(fin);
+        }
+        moves = pgn;
+    }
+
+    else {
+        if ((ptr = strstr(str, "fen ")) != NULL) {
+            strncpy(fen, ptr + strlen("fen "), sizeof(fen) - 1);
+            fen[sizeof(fen) - 1] = '\0';
+            if ((ptr = strstr(fen, " moves")) != NULL) *ptr = '\0';
+        }
+        if ((ptr = strstr(str, "moves ")) != NULL)
+            moves = ptr + strlen("moves ");
+    }
+
+    // Replay the game, saving the position before each of the moves
+    boardFromFEN(&boards[0], fen);
+
+    for (ptr = moves ? strtok(moves, " ") : NULL; ptr != NULL; ptr = strtok(NULL, " ")) {
+
+        // Skip move numbers, which may be attached to the move itself
+        if (strrchr(ptr, '.') != NULL) ptr = strrchr(ptr, '.') + 1;
+
+        // Skip NAGs, and stop at the result, which ends the game
+        if (ptr[0] == '\0' || ptr[0] == '$') continue;
+
+        if (   stringEquals(ptr, "*")   || stringEquals(ptr, "1-0")
+            || stringEquals(ptr, "0-1") || stringEquals(ptr, "1/2-1/2"))
+            break;
+
+        if (plies == ANALYSIS_MAX_PLIES) break;
+
+        if ((played[plies] = parseGameMove(&boards[plies], ptr)) == NONE_MOVE) {
+            writerPrintf("info string illegal move %s at ply %d\n", ptr, plies + 1);
+            break;
+        }
+
+        boards[plies+1] = boards[plies];
+        applyMove(&boards[plies+1], played[plies], &undo);
+        plies++;
+
+        // Keep the repetition history from growing past the Board's limit
+        if (boards[plies].fiftyMoveRule == 0) boards[plies].numMoves = 0;
+    }
+
+    start = getRealTime();
+
+    // Analyse from the end of the game towards the start, keeping the TT and the
+    // history tables, so that deep results from later positions are available to
+    // the searches of the earlier positions which lead to them
+    for (first = plies; first >= 0 && !AnalysisStopped; first--) {
+
+        const int i = first;
+
+        size = 0;
+        genAllLegalMoves(&boards[i], legal, &size);
+
+        // The game may well end in a checkmate or a stalemate
+        if (size == 0) {
+            values[i] = boards[i].kingAttackers ? -MATE : 0;
+            bests[i] = NONE_MOVE;
+            continue;
+        }
+
+        limits.start = getRealTime();
+        getBestMove(threads, &boards[i], &limits, &bests[i], &ponder);
+        nodes += nodesSearchedThreadPool(threads);
+
+        // A stopped search has no result for this position
+        if (AnalysisStopped) break;
+        values[i] = threads[0].value;
+    }
+
+    // Report each ply of the game, with scores from the view of White. The loss
+    // compares the best score to the score after the move which was played. If
+    // stopped, only the plies after the last analysed position can be reported
+    writerPrintf("\n ply   move   best  score   loss\n");
+
+    for (int i = first + 1; i < plies; i++) {
+
+        value = boards[i].turn == WHITE ? values[i] : -values[i];
+        moveToString(played[i], playedStr);
+        moveToString(bests[i], bestStr);
+
+        writerPrintf("%4d %6s %6s %6d %6d\n", i + 1, playedStr, bestStr,
+                     value, MAX(0, values[i] + values[i+1]));
+    }
+
+    writerPrintf("\nTime  : %dms\n", (int)(getRealTime() - start));
+    writerPrintf("Nodes : %"PRIu64"\n", nodes);
+}
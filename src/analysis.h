@@ -0,0 +1,37 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "types.h"
+
+enum {
+    ANALYSIS_MAX_PLIES = 1024, // Longest game accepted for analysis
+    ANALYSIS_DEPTH     =   12, // Depth used unless a limit is given
+};
+
+void moveToSAN(Board *board, uint16_t move, char *str);
+uint16_t parseGameMove(Board *board, char *token);
+int readPGNGame(FILE *fin, char *fen, char *result, char *moves, int size);
+void resetGameAnalysis();
+void stopGameAnalysis();
+void runGameAnalysis(Thread *threads, char *str);
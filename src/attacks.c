@@ -25,19 +25,10 @@
 
 #include "attacks.h"
 #include "bitboards.h"
+#include "numa.h"
 #include "types.h"
 
 
-uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
-uint64_t KnightAttacks[SQUARE_NB];
-uint64_t BishopAttacks[0x1480];
-uint64_t RookAttacks[0x19000];
-uint64_t KingAttacks[SQUARE_NB];
-
-Magic BishopTable[SQUARE_NB];
-Magic RookTable[SQUARE_NB];
-
-
 static int validCoordinate(int rank, int file) {
     return 0 <= rank && rank < 8
         && 0 <= file && file < 8;
@@ -48,7 +39,7 @@ static void setSquare(uint64_t *bb, int rank, int file){
         *bb |= 1ull << square(rank, file);
 }
 
-static int sliderIndex(uint64_t occupied, Magic *table) {
+static int sliderIndex(uint64_t occupied, const Magic *table) {
 #ifdef USE_PEXT
     return _pext_u64(occupied, table->mask);
 #else
@@ -108,51 +99,51 @@ void initAttacks() {
     const int KingDelta[8][2]   = {{-1,-1}, {-1, 0}, {-1, 1}, { 0,-1},{ 0, 1}, { 1,-1}, { 1, 0}, { 1, 1}};
 
     // First square has initial offset
-    BishopTable[0].offset = BishopAttacks;
-    RookTable[0].offset = RookAttacks;
+    MainTables.BishopTable[0].offset = MainTables.BishopAttacks;
+    MainTables.RookTable[0].offset = MainTables.RookAttacks;
 
     // Init attack tables for Pawns
     for (int sq = 0; sq < 64; sq++) {
         for (int dir = 0; dir < 2; dir++) {
-            setSquare(&PawnAttacks[WHITE][sq], rankOf(sq) + PawnDelta[dir][0], fileOf(sq) + PawnDelta[dir][1]);
-            setSquare(&PawnAttacks[BLACK][sq], rankOf(sq) - PawnDelta[dir][0], fileOf(sq) - PawnDelta[dir][1]);
+            setSquare(&MainTables.PawnAttacks[WHITE][sq], rankOf(sq) + PawnDelta[dir][0], fileOf(sq) + PawnDelta[dir][1]);
+            setSquare(&MainTables.PawnAttacks[BLACK][sq], rankOf(sq) - PawnDelta[dir][0], fileOf(sq) - PawnDelta[dir][1]);
         }
     }
 
     // Init attack tables for Knights & Kings
     for (int sq = 0; sq < 64; sq++) {
         for (int dir = 0; dir < 8; dir++) {
-            setSquare(&KnightAttacks[sq], rankOf(sq) + KnightDelta[dir][0], fileOf(sq) + KnightDelta[dir][1]);
-            setSquare(  &KingAttacks[sq], rankOf(sq) +   KingDelta[dir][0], fileOf(sq) +   KingDelta[dir][1]);
+            setSquare(&MainTables.KnightAttacks[sq], rankOf(sq) + KnightDelta[dir][0], fileOf(sq) + KnightDelta[dir][1]);
+            setSquare(  &MainTables.KingAttacks[sq], rankOf(sq) +   KingDelta[dir][0], fileOf(sq) +   KingDelta[dir][1]);
         }
     }
 
     // Init attack tables for sliding pieces
     for (int sq = 0; sq < 64; sq++) {
-        initSliderAttacks(sq, BishopTable, BishopMagics[sq], BishopDelta);
-        initSliderAttacks(sq,   RookTable,   RookMagics[sq],   RookDelta);
+        initSliderAttacks(sq, MainTables.BishopTable, BishopMagics[sq], BishopDelta);
+        initSliderAttacks(sq,   MainTables.RookTable,   RookMagics[sq],   RookDelta);
     }
 }
 
 uint64_t pawnAttacks(int colour, int sq) {
     assert(0 <= colour && colour < COLOUR_NB);
     assert(0 <= sq && sq < SQUARE_NB);
-    return PawnAttacks[colour][sq];
+    return Tables->PawnAttacks[colour][sq];
 }
 
 uint64_t knightAttacks(int sq) {
     assert(0 <= sq && sq < SQUARE_NB);
-    return KnightAttacks[sq];
+    return Tables->KnightAttacks[sq];
 }
 
 uint64_t bishopAttacks(int sq, uint64_t occupied) {
     assert(0 <= sq && sq < SQUARE_NB);
-    return BishopTable[sq].offset[sliderIndex(occupied, &BishopTable[sq])];
+    return Tables->BishopTable[sq].offset[sliderIndex(occupied, &Tables->BishopTable[sq])];
 }
 
 uint64_t rookAttacks(int sq, uint64_t occupied) {
     assert(0 <= sq && sq < SQUARE_NB);
-    return RookTable[sq].offset[sliderIndex(occupied, &RookTable[sq])];
+    return Tables->RookTable[sq].offset[sliderIndex(occupied, &Tables->RookTable[sq])];
 }
 
 uint64_t queenAttacks(int sq, uint64_t occupied) {
@@ -162,5 +153,5 @@ uint64_t queenAttacks(int sq, uint64_t occupied) {
 
 uint64_t kingAttacks(int sq) {
     assert(0 <= sq && sq < SQUARE_NB);
-    return KingAttacks[sq];
+    return Tables->KingAttacks[sq];
 }
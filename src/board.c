@@ -28,6 +28,7 @@
 #include "board.h"
 #include "castle.h"
 #include "masks.h"
+#include "numa.h"
 #include "psqt.h"
 #include "search.h"
 #include "time.h"
@@ -37,11 +38,12 @@
 #include "types.h"
 #include "move.h"
 #include "movegen.h"
+#include "writer.h"
 #include "zobrist.h"
 
 const char *PieceLabel[COLOUR_NB] = {"PNBRQK", "pnbrqk"};
 
-static const char *Benchmarks[] = {
+const char *Benchmarks[] = {
     #include "bench.csv"
     ""
 };
@@ -62,10 +64,10 @@ static void setSquare(Board *board, int colour, int piece, int sq) {
     setBit(&board->colours[colour], sq);
     setBit(&board->pieces[piece], sq);
 
-    board->psqtmat += PSQT[board->squares[sq]][sq];
-    board->hash ^= ZobristKeys[board->squares[sq]][sq];
+    board->psqtmat += Tables->PSQT[board->squares[sq]][sq];
+    board->hash ^= Tables->ZobristKeys[board->squares[sq]][sq];
     if (piece == PAWN || piece == KING)
-        board->pkhash ^= ZobristKeys[board->squares[sq]][sq];
+        board->pkhash ^= Tables->ZobristKeys[board->squares[sq]][sq];
 }
 
 static int stringToSquare(const char *str) {
@@ -114,7 +116,7 @@ void boardFromFEN(Board *board, const char *fen) {
     // Turn of play
     token = strtok_r(NULL, " ", &strPos);
     board->turn = token[0] == 'w' ? WHITE : BLACK;
-    if (board->turn == BLACK) board->hash ^= ZobristTurnKey;
+    if (board->turn == BLACK) board->hash ^= Tables->ZobristTurnKey;
 
     // Castling rights
     token = strtok_r(NULL, " ", &strPos);
@@ -130,12 +132,12 @@ void boardFromFEN(Board *board, const char *fen) {
             board->castleRights |= BLACK_QUEEN_RIGHTS;
     }
 
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
 
     // En passant
     board->epSquare = stringToSquare(strtok_r(NULL, " ", &strPos));
     if (board->epSquare != -1)
-        board->hash ^= ZobristEnpassKeys[fileOf(board->epSquare)];
+        board->hash ^= Tables->ZobristEnpassKeys[fileOf(board->epSquare)];
 
     // 50 move counter
     board->fiftyMoveRule = atoi(strtok_r(NULL, " ", &strPos));
@@ -211,8 +213,8 @@ void printBoard(Board *board) {
     // Print each row of the board, starting from the top
     for(i = 56, file = 8; i >= 0; i -= 8, file--){
 
-        printf("\n     |----|----|----|----|----|----|----|----|\n");
-        printf("   %d ", file);
+        writerPrintf("\n     |----|----|----|----|----|----|----|----|\n");
+        writerPrintf("   %d ", file);
 
         // Print each square in a row, starting from the left
         for(j = 0; j < 8; j++){
@@ -220,21 +222,21 @@ void printBoard(Board *board) {
             type = pieceType(board->squares[i+j]);
 
             switch(colour){
-                case WHITE: printf("| *%c ", table[colour][type]); break;
-                case BLACK: printf("|  %c ", table[colour][type]); break;
-                default   : printf("|    "); break;
+                case WHITE: writerPrintf("| *%c ", table[colour][type]); break;
+                case BLACK: writerPrintf("|  %c ", table[colour][type]); break;
+                default   : writerPrintf("|    "); break;
             }
         }
 
-        printf("|");
+        writerPrintf("|");
     }
 
-    printf("\n     |----|----|----|----|----|----|----|----|");
-    printf("\n        A    B    C    D    E    F    G    H\n");
+    writerPrintf("\n     |----|----|----|----|----|----|----|----|");
+    writerPrintf("\n        A    B    C    D    E    F    G    H\n");
 
     // Print FEN
     boardToFEN(board, fen);
-    printf("\n%s\n\n", fen);
+    writerPrintf("\n%s\n\n", fen);
 }
 
 uint64_t perft(Board *board, int depth){
@@ -279,7 +281,7 @@ void runBenchmark(Thread *threads, int depth) {
 
     // Search each benchmark position
     for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
-        printf("\nPosition #%d: %s\n", i + 1, Benchmarks[i]);
+        writerPrintf("\nPosition #%d: %s\n", i + 1, Benchmarks[i]);
         boardFromFEN(&board, Benchmarks[i]);
 
         limits.start = getRealTime();
@@ -291,10 +293,29 @@ void runBenchmark(Thread *threads, int depth) {
 
     end = getRealTime();
 
-    printf("\n------------------------\n");
-    printf("Time  : %dms\n", (int)(end - start));
-    printf("Nodes : %"PRIu64"\n", nodes);
-    printf("NPS   : %d\n", (int)(nodes / ((end - start) / 1000.0)));
+    writerPrintf("\n------------------------\n");
+    writerPrintf("Time  : %dms\n", (int)(end - start));
+    writerPrintf("Nodes : %"PRIu64"\n", nodes);
+    writerPrintf("NPS   : %d\n", (int)(nodes / ((end - start) / 1000.0)));
+}
+
+uint64_t searchBenchmarkPosition(Thread *thread, const char *fen, Limits *limits) {
+
+    Board board;
+    SearchInfo info;
+
+    boardFromFEN(&board, fen);
+
+    memset(&info, 0, sizeof(SearchInfo));
+    initTimeManagment(&info, limits);
+    newSearchThreadPool(thread, &board, limits, &info);
+
+    // Iterative deepening on a single Thread, for the tools measuring speed,
+    // without the reporting or time management done by getBestMove()
+    for (thread->depth = 1; thread->depth <= limits->depthLimit; thread->depth++)
+        thread->value = aspirationWindow(thread, thread->depth, thread->value);
+
+    return thread->nodes;
 }
 
 int boardIsDrawn(Board *board, int height) {
@@ -21,6 +21,7 @@
 #include "types.h"
 
 extern const char *PieceLabel[COLOUR_NB];
+extern const char *Benchmarks[];
 
 struct Board {
     uint8_t squares[SQUARE_NB];
@@ -57,6 +58,7 @@ void boardToFEN(Board *board, char *fen);
 void printBoard(Board *board);
 uint64_t perft(Board *board, int depth);
 void runBenchmark(Thread *threads, int depth);
+uint64_t searchBenchmarkPosition(Thread *thread, const char *fen, Limits *limits);
 
 int boardIsDrawn(Board *board, int height);
 int drawnByFiftyMoveRule(Board *board);
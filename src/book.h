@@ -0,0 +1,56 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "types.h"
+
+enum {
+    BOOK_RUN_ENTRIES = 1 << 20, // Entries sorted in memory before spilling a run
+    BOOK_MAX_RUNS    =      64, // Runs on disk before they are merged together
+    BOOK_MAX_PLY     =     256, // Deepest ply which may be added to the book
+    BOOK_DEFAULT_PLY =      40, // Depth of the book when no maxply is given
+    BOOK_GAME_TEXT   = 1 << 16, // Longest movetext read for a single PGN game
+};
+
+enum {
+    BOOK_WIN_WEIGHT  = 2, // Polyglot convention for the results of a game,
+    BOOK_DRAW_WEIGHT = 1, // scored from the view of the side to move
+};
+
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint32_t weight;
+};
+
+struct BookBuilder {
+    BookEntry *entries;
+    FILE *runs[BOOK_MAX_RUNS];
+    int length, nruns, maxply;
+    uint64_t games, positions;
+};
+
+uint64_t polyglotKey(Board *board);
+uint16_t polyglotMove(uint16_t move);
+
+void runMakeBook(char *str);
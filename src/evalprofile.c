@@ -0,0 +1,221 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#else
+    #include <time.h>
+#endif
+
+#include "bitboards.h"
+#include "board.h"
+#include "evalprofile.h"
+#include "evaluate.h"
+#include "types.h"
+
+#ifdef TUNE
+    extern _Thread_local SparseTrace ST;
+#endif
+
+// Replay a corpus of positions through the evaluation, one evaluator at a time,
+// recording the cycles spent in each and the size of the score it contributes.
+// Pawn and King terms are normally cached in the PawnKingTable, which we skip
+// here so that their full cost is seen. Run as "evalprofile <file of FENs>"
+
+typedef int (*Evaluator)(EvalInfo *ei, Board *board, int colour);
+typedef void (*Initializer)(EvalInfo *ei, Board *board, PawnKingTable *pktable);
+
+// Called through volatile pointers, so that the compiler may neither inline
+// the work nor move any of it outside of the reads of the counter
+static Initializer volatile ProfileInitializer = initializeEvalInfo;
+
+static Evaluator volatile ProfileEvaluators[PROFILE_NB] = {
+    [PROFILE_PAWNS  ] = evaluatePawns,   [PROFILE_KNIGHTS] = evaluateKnights,
+    [PROFILE_BISHOPS] = evaluateBishops, [PROFILE_ROOKS  ] = evaluateRooks,
+    [PROFILE_QUEENS ] = evaluateQueens,  [PROFILE_KINGS  ] = evaluateKings,
+    [PROFILE_PASSED ] = evaluatePassedPawns, [PROFILE_THREATS] = evaluateThreats,
+};
+
+static const char *ProfileNames[PROFILE_NB] = {
+    "initializeEvalInfo", "evaluatePawns", "evaluateKnights", "evaluateBishops",
+    "evaluateRooks", "evaluateQueens", "evaluateKings", "evaluatePassedPawns",
+    "evaluateThreats", "evaluateScaleFactor", "psqt & material",
+};
+
+static uint64_t profileTicks() {
+
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ticks;
+    _mm_lfence(); // Keep the work being measured on its side of the read
+    ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    struct timespec ts; // Nanoseconds, where there is no cycle counter
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint64_t profileOverhead() {
+
+    uint64_t total = 0ull;
+
+    // The typical cost of reading the counter, taken from each measurement
+    for (int i = 0; i < 10000; i++) {
+        uint64_t start = profileTicks();
+        total += profileTicks() - start;
+    }
+
+    return total / 10000;
+}
+
+static int profilePhase(Board *board) {
+
+    // Matches the phase calculation of evaluateBoard()
+    int phase = 24 - 4 * popcount(board->pieces[QUEEN ])
+                   - 2 * popcount(board->pieces[ROOK  ])
+                   - 1 * popcount(board->pieces[KNIGHT]
+                                 |board->pieces[BISHOP]);
+    return (phase * 256 + 12) / 24;
+}
+
+static int profileScore(int score, int phase, int factor) {
+    return (ScoreMG(score) * (256 - phase)
+         +  ScoreEG(score) * phase * factor / SCALE_NORMAL) / 256;
+}
+
+static void profilePosition(Board *board, ProfileStats *stats, uint64_t overhead) {
+
+    EvalInfo ei;
+    uint64_t start, elapsed;
+    int score, factor, eval = 0, phase = profilePhase(board);
+
+    // Each measurement is sandwiched between reads of the counter, and the
+    // evaluators are called in the same order as evaluatePieces()
+    start = profileTicks();
+    ProfileInitializer(&ei, board, NULL);
+    elapsed = profileTicks() - start;
+    stats[PROFILE_INIT].cycles += elapsed - MIN(elapsed, overhead);
+
+    for (int i = PROFILE_PAWNS; i <= PROFILE_THREATS; i++) {
+
+    #ifdef TUNE
+        int length = ST.length;
+    #endif
+
+        int pkeval = ei.pkeval[WHITE] - ei.pkeval[BLACK];
+
+        start   = profileTicks();
+        score   = ProfileEvaluators[i](&ei, board, WHITE)
+                - ProfileEvaluators[i](&ei, board, BLACK);
+        elapsed = profileTicks() - start;
+
+        // Pawn and King terms destined for the PawnKingTable are kept aside
+        score += ei.pkeval[WHITE] - ei.pkeval[BLACK] - pkeval;
+
+        stats[i].cycles += elapsed - MIN(elapsed, overhead);
+        stats[i].contribution += abs(profileScore(score, phase, SCALE_NORMAL));
+        eval += score;
+
+    #ifdef TUNE
+        stats[i].terms += ST.length - length;
+    #endif
+    }
+
+    eval += board->psqtmat;
+    stats[PROFILE_PSQT].contribution += abs(profileScore(board->psqtmat, phase, SCALE_NORMAL));
+
+    // The scale factor contributes by how far it moves the final evaluation
+    start   = profileTicks();
+    factor  = evaluateScaleFactor(board);
+    elapsed = profileTicks() - start;
+
+    stats[PROFILE_SCALE].cycles += elapsed - MIN(elapsed, overhead);
+    stats[PROFILE_SCALE].contribution += abs(profileScore(eval, phase, factor)
+                                           - profileScore(eval, phase, SCALE_NORMAL));
+}
+
+void runEvalProfile(char *path) {
+
+    Board board;
+    ProfileStats stats[PROFILE_NB] = {0};
+    uint64_t positions = 0ull, total = 0ull, overhead, start, elapsed;
+    char line[1024], fen[1024], *ptr;
+    int fields;
+    FILE *fin = fopen(path, "r");
+
+    if (fin == NULL) {
+        printf("Unable to read position file %s\n", path);
+        return;
+    }
+
+    overhead = profileOverhead();
+
+    while (fgets(line, sizeof(line), fin) != NULL) {
+
+        // Accept EPD lines, which lack the move counters, as well as FENs
+        for (ptr = line, fields = 0; *ptr && *ptr != '\n'; ptr++)
+            if (*ptr == ' ' && ++fields == 4) break;
+
+        if (fields < 4) continue;
+
+        snprintf(fen, sizeof(fen), "%.*s 0 1", (int)(ptr - line), line);
+        boardFromFEN(&board, fen);
+
+        // Warm the caches, and time the full evaluation for comparison
+        evaluateBoard(&board, NULL, NULL);
+        start = profileTicks();
+        evaluateBoard(&board, NULL, NULL);
+        elapsed = profileTicks() - start;
+        total += elapsed - MIN(elapsed, overhead);
+
+        profilePosition(&board, stats, overhead);
+        positions++;
+    }
+
+    fclose(fin);
+
+    if (positions == 0) {
+        printf("No positions found in %s\n", path);
+        return;
+    }
+
+    printf("Profiled %"PRIu64" positions, with a counter overhead of %"PRIu64"\n\n", positions, overhead);
+    printf("Evaluator              Cycles   Share   Avg |cp|\n");
+
+    for (int i = 0; i < PROFILE_NB; i++) {
+        printf("%-20s %8.1f %6.1f%% %10.1f", ProfileNames[i],
+            (double) stats[i].cycles / positions,
+            100.0 * stats[i].cycles / MAX(1ull, total),
+            (double) stats[i].contribution / positions);
+    #ifdef TUNE
+        printf("   %6.1f terms", (double) stats[i].terms / positions);
+    #endif
+        printf("\n");
+    }
+
+    printf("%-20s %8.1f\n", "evaluateBoard", (double) total / positions);
+}
@@ -35,45 +35,65 @@
 
 #ifdef TUNE
     const int TRACE = 1;
-    const EvalTrace EmptyTrace;
     EvalTrace T;
+    _Thread_local SparseTrace ST;
 #else
     const int TRACE = 0;
     EvalTrace T;
+    SparseTrace ST;
 #endif
 
+// The tuner needs only the terms used by a position, so rather than filling out
+// the entire EvalTrace we record the offset of each term within it, along with
+// the count. The offset encodes the term, the index into it, and the colour
+
+static void traceOverflow() {
+    printf("Error in TraceAdd(): more than %d records\n", MAX_TRACE_RECORDS);
+    exit(EXIT_FAILURE);
+}
+
+#define TraceAdd(term, value) do {                              \
+    if (TRACE) {                                                \
+        if (ST.length == MAX_TRACE_RECORDS) traceOverflow();    \
+        ST.records[ST.length  ].offset = &T.term - (int*) &T;   \
+        ST.records[ST.length++].count  = (value);               \
+    }                                                           \
+} while (0)
+
+#define TraceIncr(term) TraceAdd(term, 1)
+
 #define S(mg, eg) (MakeScore((mg), (eg)))
 
 /* Material Value Evaluation Terms */
 
-const int PawnValue   = S( 110, 129);
-const int KnightValue = S( 460, 412);
-const int BishopValue = S( 481, 430);
-const int RookValue   = S( 677, 714);
-const int QueenValue  = S(1263,1375);
-const int KingValue   = S(   0,   0);
+int PawnValue   = S( 110, 129);
+int KnightValue = S( 460, 412);
+int BishopValue = S( 481, 430);
+int RookValue   = S( 677, 714);
+int QueenValue  = S(1263,1375);
+int KingValue   = S(   0,   0);
 
-const int PieceValues[8][PHASE_NB] = {
+int PieceValues[8][PHASE_NB] = {
     { 110, 129}, { 460, 412}, { 481, 430}, { 677, 714},
     {1263,1375}, {   0,   0}, {   0,   0}, {   0,   0},
 };
 
 /* Pawn Evaluation Terms */
 
-const int PawnCandidatePasser[2][RANK_NB] = {
+int PawnCandidatePasser[2][RANK_NB] = {
    {S(   0,   0), S( -26, -11), S( -12,   9), S( -12,  27),
     S(   3,  62), S(  47,  68), S(   0,   0), S(   0,   0)},
    {S(   0,   0), S( -13,  14), S(  -5,  21), S(   4,  44),
     S(  16,  85), S(  33,  52), S(   0,   0), S(   0,   0)},
 };
 
-const int PawnIsolated = S(  -8, -10);
+int PawnIsolated = S(  -8, -10);
 
-const int PawnStacked = S( -19, -26);
+int PawnStacked = S( -19, -26);
 
-const int PawnBackwards[2] = { S(   8,  -2), S(  -6, -18) };
+int PawnBackwards[2] = { S(   8,  -2), S(  -6, -18) };
 
-const int PawnConnected32[32] = {
+int PawnConnected32[32] = {
     S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
     S(  -2,  -7), S(  11,   0), S(   4,   0), S(   4,  18),
     S(  15,   0), S(  34,  -1), S(  22,  10), S(  26,  18),
@@ -86,11 +106,11 @@ const int PawnConnected32[32] = {
 
 /* Knight Evaluation Terms */
 
-const int KnightOutpost[2] = { S(   7, -25), S(  31,  -3) };
+int KnightOutpost[2] = { S(   7, -25), S(  31,  -3) };
 
-const int KnightBehindPawn = S(   4,  21);
+int KnightBehindPawn = S(   4,  21);
 
-const int KnightMobility[9] = {
+int KnightMobility[9] = {
     S( -81,-101), S( -32, -99), S( -17, -43), S(  -3, -17),
     S(   8,  -6), S(  15,   8), S(  24,  12), S(  34,  12),
     S(  45,   0),
@@ -98,15 +118,15 @@ const int KnightMobility[9] = {
 
 /* Bishop Evaluation Terms */
 
-const int BishopPair = S(  26,  70);
+int BishopPair = S(  26,  70);
 
-const int BishopRammedPawns = S( -10, -16);
+int BishopRammedPawns = S( -10, -16);
 
-const int BishopOutpost[2] = { S(  10, -11), S(  42,   0) };
+int BishopOutpost[2] = { S(  10, -11), S(  42,   0) };
 
-const int BishopBehindPawn = S(   3,  19);
+int BishopBehindPawn = S(   3,  19);
 
-const int BishopMobility[14] = {
+int BishopMobility[14] = {
     S( -64,-146), S( -28, -95), S(  -8, -55), S(   2, -29),
     S(  12, -16), S(  19,  -1), S(  22,   8), S(  22,  14),
     S(  22,  19), S(  24,  20), S(  23,  20), S(  39,   9),
@@ -115,11 +135,11 @@ const int BishopMobility[14] = {
 
 /* Rook Evaluation Terms */
 
-const int RookFile[2] = { S(  18,   6), S(  40,   2) };
+int RookFile[2] = { S(  18,   6), S(  40,   2) };
 
-const int RookOnSeventh = S(   0,  32);
+int RookOnSeventh = S(   0,  32);
 
-const int RookMobility[15] = {
+int RookMobility[15] = {
     S(-149,-112), S( -52,-116), S( -12, -62), S(  -4, -20),
     S(  -5,   0), S(  -5,  15), S(  -4,  25), S(   1,  28),
     S(   8,  31), S(  11,  36), S(  14,  42), S(  18,  46),
@@ -128,7 +148,7 @@ const int RookMobility[15] = {
 
 /* Queen Evaluation Terms */
 
-const int QueenMobility[28] = {
+int QueenMobility[28] = {
     S( -61,-263), S(-211,-387), S( -60,-202), S( -25,-192),
     S( -13,-141), S(  -8, -90), S(  -2, -62), S(  -3, -35),
     S(   0, -24), S(   0,  -1), S(   3,  10), S(   4,  23),
@@ -140,13 +160,13 @@ const int QueenMobility[28] = {
 
 /* King Evaluation Terms */
 
-const int KingDefenders[12] = {
+int KingDefenders[12] = {
     S( -21,  -3), S(  -9,   0), S(   0,   2), S(   7,   4),
     S(  16,   5), S(  27,   2), S(  32,   0), S(  14,   0),
     S(  12,   6), S(  12,   6), S(  12,   6), S(  12,   6),
 };
 
-const int KingShelter[2][FILE_NB][RANK_NB] = {
+int KingShelter[2][FILE_NB][RANK_NB] = {
   {{S( -12,   4), S(  16, -24), S(  18,  -9), S(   9,   2),
     S(   4,   3), S(   7,   2), S(  -2, -32), S( -49,  19)},
    {S(  16,  -6), S(  23, -18), S(   0,  -5), S( -17,   2),
@@ -181,7 +201,7 @@ const int KingShelter[2][FILE_NB][RANK_NB] = {
     S( -17,  15), S(  -1,  15), S(-229, -57), S( -23,   6)}},
 };
 
-const int KingStorm[2][FILE_NB/2][RANK_NB] = {
+int KingStorm[2][FILE_NB/2][RANK_NB] = {
   {{S(   1,  23), S( 114, -11), S( -26,  24), S( -22,  10),
     S( -13,   2), S(  -8,  -2), S( -18,   6), S( -22,  -2)},
    {S(   0,  45), S(  57,  11), S( -18,  23), S(  -6,  11),
@@ -215,7 +235,7 @@ const int KSAdjustment      =  -18;
 
 /* Passed Pawn Evaluation Terms */
 
-const int PassedPawn[2][2][RANK_NB] = {
+int PassedPawn[2][2][RANK_NB] = {
   {{S(   0,   0), S( -38,   0), S( -53,  22), S( -83,  26),
     S(  -6,  16), S(  66,   0), S( 152,  59), S(   0,   0)},
    {S(   0,   0), S( -26,   1), S( -46,  20), S( -71,  25),
@@ -226,28 +246,28 @@ const int PassedPawn[2][2][RANK_NB] = {
     S(  -3,  58), S(  76, 140), S( 156, 302), S(   0,   0)}},
 };
 
-const int PassedFriendlyDistance[RANK_NB] = {
+int PassedFriendlyDistance[RANK_NB] = {
     S(   0,   0), S(   0,   0), S(   3,  -3), S(   7, -11),
     S(   6, -16), S(  -6, -16), S( -13, -11), S(   0,   0),
 };
 
-const int PassedEnemyDistance[RANK_NB] = {
+int PassedEnemyDistance[RANK_NB] = {
     S(   0,   0), S(   3,   0), S(   4,   1), S(   8,  10),
     S(   1,  25), S(   8,  34), S(  24,  37), S(   0,   0),
 };
 
-const int PassedSafePromotionPath = S( -27,  36);
+int PassedSafePromotionPath = S( -27,  36);
 
 /* Threat Evaluation Terms */
 
-const int ThreatWeakPawn             = S( -14, -28);
-const int ThreatMinorAttackedByPawn  = S( -56, -47);
-const int ThreatMinorAttackedByMinor = S( -28, -35);
-const int ThreatMinorAttackedByMajor = S( -25, -44);
-const int ThreatRookAttackedByLesser = S( -58, -10);
-const int ThreatQueenAttackedByOne   = S( -48, -15);
-const int ThreatOverloadedPieces     = S(  -8, -16);
-const int ThreatByPawnPush           = S(  16,  20);
+int ThreatWeakPawn             = S( -14, -28);
+int ThreatMinorAttackedByPawn  = S( -56, -47);
+int ThreatMinorAttackedByMinor = S( -28, -35);
+int ThreatMinorAttackedByMajor = S( -25, -44);
+int ThreatRookAttackedByLesser = S( -58, -10);
+int ThreatQueenAttackedByOne   = S( -48, -15);
+int ThreatOverloadedPieces     = S(  -8, -16);
+int ThreatByPawnPush           = S(  16,  20);
 
 /* General Evaluation Terms */
 
@@ -255,13 +275,38 @@ const int Tempo[COLOUR_NB] = { S(  25,  12), S( -25, -12) };
 
 #undef S
 
-int evaluateBoard(Board* board, PawnKingTable* pktable){
+static void shareBishopAttacks(EvalInfo *ei, Board *board, int colour, int sq, uint64_t attacks) {
+
+    // Our x-ray attacks, through our own Bishops and Queens, match the attacks
+    // used by the move generator unless one of those pieces is on the diagonals
+    if (   ei->cache != NULL && colour == board->turn
+        && !(attacks & board->colours[colour] & (board->pieces[BISHOP] | board->pieces[QUEEN]))) {
+        ei->cache->bishop[sq] = attacks;
+        setBit(&ei->cache->bishopValid, sq);
+    }
+}
+
+static void shareRookAttacks(EvalInfo *ei, Board *board, int colour, int sq, uint64_t attacks) {
+
+    // As above, with the x-rays through our own Rooks and Queens
+    if (   ei->cache != NULL && colour == board->turn
+        && !(attacks & board->colours[colour] & (board->pieces[ROOK] | board->pieces[QUEEN]))) {
+        ei->cache->rook[sq] = attacks;
+        setBit(&ei->cache->rookValid, sq);
+    }
+}
+
+int evaluateBoard(Board* board, PawnKingTable* pktable, AttackCache* cache){
 
     EvalInfo ei;
     int phase, factor, eval, pkeval;
 
+    // Each trace covers only the most recent evaluation
+    if (TRACE) ST.length = 0;
+
     // Setup and perform all evaluations
     initializeEvalInfo(&ei, board, pktable);
+    ei.cache = cache;
     eval   = evaluatePieces(&ei, board);
     pkeval = ei.pkeval[WHITE] - ei.pkeval[BLACK];
     eval  += pkeval + board->psqtmat + Tempo[board->turn];
@@ -348,8 +393,8 @@ int evaluatePawns(EvalInfo *ei, Board *board, int colour) {
 
         // Pop off the next pawn
         sq = poplsb(&tempPawns);
-        if (TRACE) T.PawnValue[US]++;
-        if (TRACE) T.PawnPSQT32[relativeSquare32(sq, US)][US]++;
+        TraceIncr(PawnValue[US]);
+        TraceIncr(PawnPSQT32[relativeSquare32(sq, US)][US]);
 
         uint64_t stoppers    = enemyPawns & passedPawnMasks(US, sq);
         uint64_t threats     = enemyPawns & pawnAttacks(US, sq);
@@ -366,19 +411,19 @@ int evaluatePawns(EvalInfo *ei, Board *board, int colour) {
         else if (!leftovers && popcount(pushSupport) >= popcount(pushThreats)) {
             flag = popcount(support) >= popcount(threats);
             pkeval += PawnCandidatePasser[flag][relativeRankOf(US, sq)];
-            if (TRACE) T.PawnCandidatePasser[flag][relativeRankOf(US, sq)][US]++;
+            TraceIncr(PawnCandidatePasser[flag][relativeRankOf(US, sq)][US]);
         }
 
         // Apply a penalty if the pawn is isolated
         if (!(adjacentFilesMasks(fileOf(sq)) & myPawns)) {
             pkeval += PawnIsolated;
-            if (TRACE) T.PawnIsolated[US]++;
+            TraceIncr(PawnIsolated[US]);
         }
 
         // Apply a penalty if the pawn is stacked
         if (Files[fileOf(sq)] & tempPawns) {
             pkeval += PawnStacked;
-            if (TRACE) T.PawnStacked[US]++;
+            TraceIncr(PawnStacked[US]);
         }
 
         // Apply a penalty if the pawn is backward
@@ -386,13 +431,13 @@ int evaluatePawns(EvalInfo *ei, Board *board, int colour) {
             &&  (testBit(ei->pawnAttacks[THEM], sq + Forward))) {
             flag = !(Files[fileOf(sq)] & enemyPawns);
             pkeval += PawnBackwards[flag];
-            if (TRACE) T.PawnBackwards[flag][US]++;
+            TraceIncr(PawnBackwards[flag][US]);
         }
 
         // Apply a bonus if the pawn is connected and not backward
         else if (pawnConnectedMasks(US, sq) & myPawns) {
             pkeval += PawnConnected32[relativeSquare32(sq, US)];
-            if (TRACE) T.PawnConnected32[relativeSquare32(sq, US)][US]++;
+            TraceIncr(PawnConnected32[relativeSquare32(sq, US)][US]);
         }
     }
 
@@ -418,8 +463,8 @@ int evaluateKnights(EvalInfo *ei, Board *board, int colour) {
 
         // Pop off the next knight
         sq = poplsb(&tempKnights);
-        if (TRACE) T.KnightValue[US]++;
-        if (TRACE) T.KnightPSQT32[relativeSquare32(sq, US)][US]++;
+        TraceIncr(KnightValue[US]);
+        TraceIncr(KnightPSQT32[relativeSquare32(sq, US)][US]);
 
         // Compute possible attacks and store off information for king safety
         attacks = knightAttacks(sq);
@@ -433,19 +478,19 @@ int evaluateKnights(EvalInfo *ei, Board *board, int colour) {
             && !(outpostSquareMasks(US, sq) & enemyPawns)) {
             defended = testBit(ei->pawnAttacks[US], sq);
             eval += KnightOutpost[defended];
-            if (TRACE) T.KnightOutpost[defended][US]++;
+            TraceIncr(KnightOutpost[defended][US]);
         }
 
         // Apply a bonus if the knight is behind a pawn
         if (testBit(pawnAdvance(board->pieces[PAWN], 0ull, THEM), sq)) {
             eval += KnightBehindPawn;
-            if (TRACE) T.KnightBehindPawn[US]++;
+            TraceIncr(KnightBehindPawn[US]);
         }
 
         // Apply a bonus (or penalty) based on the mobility of the knight
         count = popcount(ei->mobilityAreas[US] & attacks);
         eval += KnightMobility[count];
-        if (TRACE) T.KnightMobility[count][US]++;
+        TraceIncr(KnightMobility[count][US]);
 
         // Update for King Safety calculation
         attacks = attacks & ei->kingAreas[THEM];
@@ -475,7 +520,7 @@ int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
     // Apply a bonus for having a pair of bishops
     if ((tempBishops & WHITE_SQUARES) && (tempBishops & BLACK_SQUARES)) {
         eval += BishopPair;
-        if (TRACE) T.BishopPair[US]++;
+        TraceIncr(BishopPair[US]);
     }
 
     // Evaluate each bishop
@@ -483,11 +528,12 @@ int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
 
         // Pop off the next Bishop
         sq = poplsb(&tempBishops);
-        if (TRACE) T.BishopValue[US]++;
-        if (TRACE) T.BishopPSQT32[relativeSquare32(sq, US)][US]++;
+        TraceIncr(BishopValue[US]);
+        TraceIncr(BishopPSQT32[relativeSquare32(sq, US)][US]);
 
         // Compute possible attacks and store off information for king safety
         attacks = bishopAttacks(sq, ei->occupiedMinusBishops[US]);
+        shareBishopAttacks(ei, board, US, sq, attacks);
         ei->attackedBy2[US]        |= attacks & ei->attacked[US];
         ei->attacked[US]           |= attacks;
         ei->attackedBy[US][BISHOP] |= attacks;
@@ -496,7 +542,7 @@ int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
         // of our own colour, which reside on the same shade of square as the bishop
         count = popcount(ei->rammedPawns[US] & (testBit(WHITE_SQUARES, sq) ? WHITE_SQUARES : BLACK_SQUARES));
         eval += count * BishopRammedPawns;
-        if (TRACE) T.BishopRammedPawns[US] += count;
+        TraceAdd(BishopRammedPawns[US], count);
 
         // Apply a bonus if the bishop is on an outpost square, and cannot be attacked
         // by an enemy pawn. Increase the bonus if one of our pawns supports the bishop.
@@ -504,19 +550,19 @@ int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
             && !(outpostSquareMasks(US, sq) & enemyPawns)) {
             defended = testBit(ei->pawnAttacks[US], sq);
             eval += BishopOutpost[defended];
-            if (TRACE) T.BishopOutpost[defended][US]++;
+            TraceIncr(BishopOutpost[defended][US]);
         }
 
         // Apply a bonus if the bishop is behind a pawn
         if (testBit(pawnAdvance((myPawns | enemyPawns), 0ull, THEM), sq)) {
             eval += BishopBehindPawn;
-            if (TRACE) T.BishopBehindPawn[US]++;
+            TraceIncr(BishopBehindPawn[US]);
         }
 
         // Apply a bonus (or penalty) based on the mobility of the bishop
         count = popcount(ei->mobilityAreas[US] & attacks);
         eval += BishopMobility[count];
-        if (TRACE) T.BishopMobility[count][US]++;
+        TraceIncr(BishopMobility[count][US]);
 
         // Update for King Safety calculation
         attacks = attacks & ei->kingAreas[THEM];
@@ -548,11 +594,12 @@ int evaluateRooks(EvalInfo *ei, Board *board, int colour) {
 
         // Pop off the next rook
         sq = poplsb(&tempRooks);
-        if (TRACE) T.RookValue[US]++;
-        if (TRACE) T.RookPSQT32[relativeSquare32(sq, US)][US]++;
+        TraceIncr(RookValue[US]);
+        TraceIncr(RookPSQT32[relativeSquare32(sq, US)][US]);
 
         // Compute possible attacks and store off information for king safety
         attacks = rookAttacks(sq, ei->occupiedMinusRooks[US]);
+        shareRookAttacks(ei, board, US, sq, attacks);
         ei->attackedBy2[US]      |= attacks & ei->attacked[US];
         ei->attacked[US]         |= attacks;
         ei->attackedBy[US][ROOK] |= attacks;
@@ -562,7 +609,7 @@ int evaluateRooks(EvalInfo *ei, Board *board, int colour) {
         if (!(myPawns & Files[fileOf(sq)])) {
             open = !(enemyPawns & Files[fileOf(sq)]);
             eval += RookFile[open];
-            if (TRACE) T.RookFile[open][US]++;
+            TraceIncr(RookFile[open][US]);
         }
 
         // Rook gains a bonus for being located on seventh rank relative to its
@@ -570,13 +617,13 @@ int evaluateRooks(EvalInfo *ei, Board *board, int colour) {
         if (   relativeRankOf(US, sq) == 6
             && relativeRankOf(US, ei->kingSquare[THEM]) >= 6) {
             eval += RookOnSeventh;
-            if (TRACE) T.RookOnSeventh[US]++;
+            TraceIncr(RookOnSeventh[US]);
         }
 
         // Apply a bonus (or penalty) based on the mobility of the rook
         count = popcount(ei->mobilityAreas[US] & attacks);
         eval += RookMobility[count];
-        if (TRACE) T.RookMobility[count][US]++;
+        TraceIncr(RookMobility[count][US]);
 
         // Update for King Safety calculation
         attacks = attacks & ei->kingAreas[THEM];
@@ -595,7 +642,7 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
     const int US = colour, THEM = !colour;
 
     int sq, count, eval = 0;
-    uint64_t tempQueens, attacks;
+    uint64_t tempQueens, attacks, orthogonal, diagonal;
 
     tempQueens = board->pieces[QUEEN] & board->colours[US];
 
@@ -606,12 +653,15 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
 
         // Pop off the next queen
         sq = poplsb(&tempQueens);
-        if (TRACE) T.QueenValue[US]++;
-        if (TRACE) T.QueenPSQT32[relativeSquare32(sq, US)][US]++;
+        TraceIncr(QueenValue[US]);
+        TraceIncr(QueenPSQT32[relativeSquare32(sq, US)][US]);
 
         // Compute possible attacks and store off information for king safety
-        attacks = rookAttacks(sq, ei->occupiedMinusRooks[US])
-                | bishopAttacks(sq, ei->occupiedMinusBishops[US]);
+        orthogonal = rookAttacks(sq, ei->occupiedMinusRooks[US]);
+        diagonal   = bishopAttacks(sq, ei->occupiedMinusBishops[US]);
+        shareRookAttacks(ei, board, US, sq, orthogonal);
+        shareBishopAttacks(ei, board, US, sq, diagonal);
+        attacks = orthogonal | diagonal;
         ei->attackedBy2[US]       |= attacks & ei->attacked[US];
         ei->attacked[US]          |= attacks;
         ei->attackedBy[US][QUEEN] |= attacks;
@@ -619,7 +669,7 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
         // Apply a bonus (or penalty) based on the mobility of the queen
         count = popcount(ei->mobilityAreas[US] & attacks);
         eval += QueenMobility[count];
-        if (TRACE) T.QueenMobility[count][US]++;
+        TraceIncr(QueenMobility[count][US]);
 
         // Update for King Safety calculation
         attacks = attacks & ei->kingAreas[THEM];
@@ -651,13 +701,13 @@ int evaluateKings(EvalInfo *ei, Board *board, int colour) {
     int kingFile = fileOf(kingSq);
     int kingRank = rankOf(kingSq);
 
-    if (TRACE) T.KingValue[US]++;
-    if (TRACE) T.KingPSQT32[relativeSquare32(kingSq, US)][US]++;
+    TraceIncr(KingValue[US]);
+    TraceIncr(KingPSQT32[relativeSquare32(kingSq, US)][US]);
 
     // Bonus for our pawns and minors sitting within our king area
     count = popcount(myDefenders & ei->kingAreas[US]);
     eval += KingDefenders[count];
-    if (TRACE) T.KingDefenders[count][US]++;
+    TraceIncr(KingDefenders[count][US]);
 
     // Perform King Safety when we have two attackers, or
     // one attacker with a potential for a Queen attacker
@@ -727,13 +777,13 @@ int evaluateKings(EvalInfo *ei, Board *board, int colour) {
         // Evaluate King Shelter using pawn distance. Use seperate evaluation
         // depending on the file, and if we are looking at the King's file
         ei->pkeval[US] += KingShelter[file == kingFile][file][ourDist];
-        if (TRACE) T.KingShelter[file == kingFile][file][ourDist][US]++;
+        TraceIncr(KingShelter[file == kingFile][file][ourDist][US]);
 
         // Evaluate King Storm using enemy pawn distance. Use a seperate evaluation
         // depending on the file, and if the opponent's pawn is blocked by our own
         int blocked = (ourDist != 7 && (ourDist == theirDist - 1));
         ei->pkeval[US] += KingStorm[blocked][mirrorFile(file)][theirDist];
-        if (TRACE) T.KingStorm[blocked][mirrorFile(file)][theirDist][US]++;
+        TraceIncr(KingStorm[blocked][mirrorFile(file)][theirDist][US]);
     }
 
     return eval;
@@ -761,23 +811,23 @@ int evaluatePassedPawns(EvalInfo* ei, Board* board, int colour){
         canAdvance = !(bitboard & occupied);
         safeAdvance = !(bitboard & ei->attacked[THEM]);
         eval += PassedPawn[canAdvance][safeAdvance][rank];
-        if (TRACE) T.PassedPawn[canAdvance][safeAdvance][rank][US]++;
+        TraceIncr(PassedPawn[canAdvance][safeAdvance][rank][US]);
 
         // Evaluate based on distance from our king
         dist = distanceBetween(sq, ei->kingSquare[US]);
         eval += dist * PassedFriendlyDistance[rank];
-        if (TRACE) T.PassedFriendlyDistance[rank][US] += dist;
+        TraceAdd(PassedFriendlyDistance[rank][US], dist);
 
         // Evaluate based on distance from their king
         dist = distanceBetween(sq, ei->kingSquare[THEM]);
         eval += dist * PassedEnemyDistance[rank];
-        if (TRACE) T.PassedEnemyDistance[rank][US] += dist;
+        TraceAdd(PassedEnemyDistance[rank][US], dist);
 
         // Apply a bonus when the path to promoting is uncontested
         bitboard = forwardRanksMasks(US, rankOf(sq)) & Files[fileOf(sq)];
         flag = !(bitboard & ei->attacked[THEM]);
         eval += flag * PassedSafePromotionPath;
-        if (TRACE) T.PassedSafePromotionPath[US] += flag;
+        TraceAdd(PassedSafePromotionPath[US], flag);
     }
 
     return eval;
@@ -824,42 +874,42 @@ int evaluateThreats(EvalInfo *ei, Board *board, int colour) {
     // Penalty for each of our poorly supported pawns
     count = popcount(pawns & ~attacksByPawns & poorlyDefended);
     eval += count * ThreatWeakPawn;
-    if (TRACE) T.ThreatWeakPawn[US] += count;
+    TraceAdd(ThreatWeakPawn[US], count);
 
     // Penalty for pawn threats against our minors
     count = popcount((knights | bishops) & attacksByPawns);
     eval += count * ThreatMinorAttackedByPawn;
-    if (TRACE) T.ThreatMinorAttackedByPawn[US] += count;
+    TraceAdd(ThreatMinorAttackedByPawn[US], count);
 
     // Penalty for any minor threat against minor pieces
     count = popcount((knights | bishops) & attacksByMinors);
     eval += count * ThreatMinorAttackedByMinor;
-    if (TRACE) T.ThreatMinorAttackedByMinor[US] += count;
+    TraceAdd(ThreatMinorAttackedByMinor[US], count);
 
     // Penalty for all major threats against poorly supported minors
     count = popcount((knights | bishops) & poorlyDefended & attacksByMajors);
     eval += count * ThreatMinorAttackedByMajor;
-    if (TRACE) T.ThreatMinorAttackedByMajor[US] += count;
+    TraceAdd(ThreatMinorAttackedByMajor[US], count);
 
     // Penalty for pawn and minor threats against our rooks
     count = popcount(rooks & (attacksByPawns | attacksByMinors));
     eval += count * ThreatRookAttackedByLesser;
-    if (TRACE) T.ThreatRookAttackedByLesser[US] += count;
+    TraceAdd(ThreatRookAttackedByLesser[US], count);
 
     // Penalty for any threat against our queens
     count = popcount(queens & ei->attacked[THEM]);
     eval += count * ThreatQueenAttackedByOne;
-    if (TRACE) T.ThreatQueenAttackedByOne[US] += count;
+    TraceAdd(ThreatQueenAttackedByOne[US], count);
 
     // Penalty for any overloaded minors or majors
     count = popcount(overloaded);
     eval += count * ThreatOverloadedPieces;
-    if (TRACE) T.ThreatOverloadedPieces[US] += count;
+    TraceAdd(ThreatOverloadedPieces[US], count);
 
     // Bonus for giving threats by safe pawn pushes
     count = popcount(pushThreat);
     eval += count * ThreatByPawnPush;
-    if (TRACE) T.ThreatByPawnPush[colour] += count;
+    TraceAdd(ThreatByPawnPush[colour], count);
 
     return eval;
 }
@@ -942,4 +992,6 @@ void initializeEvalInfo(EvalInfo* ei, Board* board, PawnKingTable* pktable){
     ei->passedPawns   = ei->pkentry == NULL ? 0ull : ei->pkentry->passed;
     ei->pkeval[WHITE] = ei->pkentry == NULL ? 0    : ei->pkentry->eval;
     ei->pkeval[BLACK] = ei->pkentry == NULL ? 0    : 0;
+
+    ei->cache = NULL;
 }
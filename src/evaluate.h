@@ -28,6 +28,10 @@ enum {
     SCALE_NORMAL           = 128,
 };
 
+enum {
+    MAX_TRACE_RECORDS = 1024, // Far more than any position will touch, but checked
+};
+
 struct EvalTrace {
     int PawnValue[COLOUR_NB];
     int KnightValue[COLOUR_NB];
@@ -75,6 +79,16 @@ struct EvalTrace {
     int ThreatByPawnPush[COLOUR_NB];
 };
 
+struct TraceRecord {
+    int offset;
+    int count;
+};
+
+struct SparseTrace {
+    int length;
+    TraceRecord records[MAX_TRACE_RECORDS];
+};
+
 struct EvalInfo {
     uint64_t pawnAttacks[COLOUR_NB];
     uint64_t rammedPawns[COLOUR_NB];
@@ -93,9 +107,10 @@ struct EvalInfo {
     int kingAttackersWeight[COLOUR_NB];
     int pkeval[COLOUR_NB];
     PawnKingEntry* pkentry;
+    AttackCache* cache;
 };
 
-int evaluateBoard(Board *board, PawnKingTable *pktable);
+int evaluateBoard(Board *board, PawnKingTable *pktable, AttackCache *cache);
 int evaluatePieces(EvalInfo *ei, Board *board);
 int evaluatePawns(EvalInfo *ei, Board *board, int colour);
 int evaluateKnights(EvalInfo *ei, Board *board, int colour);
@@ -113,6 +128,6 @@ void initializeEvalInfo(EvalInfo *ei, Board *board, PawnKingTable *pktable);
 #define ScoreMG(s) ((int16_t)((uint16_t)((unsigned)((s)))))
 #define ScoreEG(s) ((int16_t)((uint16_t)((unsigned)((s) + 0x8000) >> 16)))
 
-extern const int PieceValues[8][PHASE_NB];
+extern int PieceValues[8][PHASE_NB];
 
 #endif
@@ -0,0 +1,319 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "board.h"
+#include "experience.h"
+#include "move.h"
+#include "movegen.h"
+#include "transposition.h"
+#include "types.h"
+#include "writer.h"
+
+
+int EXPERIENCE_DEPTH = 16; // Set by UCI options
+
+// The log is a 16 byte header followed by a series of ExperienceEntrys.
+// Entries are only ever appended, so later entries supersede earlier ones
+static const char ExperienceMagic[16] = "Ethereal XP v1";
+
+static char ExperiencePath[4096];
+static FILE *ExperienceLog;
+
+// Results are queued by the search and written out by a background thread
+static ExperienceEntry Ring[EXPERIENCE_RING_SIZE];
+static int RingHead, RingTail, Closing;
+static pthread_t Writer;
+static pthread_mutex_t RingLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t RingSignal = PTHREAD_COND_INITIALIZER;
+
+// Hash table of the latest entry for each position, built from the log as it
+// grows. It is only used by the UCI thread, when preloading for a position
+static ExperienceEntry *Index;
+static size_t IndexMask, IndexUsed, IndexedEntries;
+
+
+static void* experienceWriter(void *unused) {
+
+    ExperienceEntry entry;
+
+    (void) unused;
+
+    pthread_mutex_lock(&RingLock);
+
+    while (1) {
+
+        while (RingHead == RingTail && !Closing)
+            pthread_cond_wait(&RingSignal, &RingLock);
+
+        // Only exit once all pending results have been written
+        if (RingHead == RingTail) break;
+
+        entry = Ring[RingTail];
+        RingTail = (RingTail + 1) % EXPERIENCE_RING_SIZE;
+
+        pthread_mutex_unlock(&RingLock);
+        fwrite(&entry, sizeof(ExperienceEntry), 1, ExperienceLog);
+        fflush(ExperienceLog);
+        pthread_mutex_lock(&RingLock);
+    }
+
+    pthread_mutex_unlock(&RingLock);
+    return NULL;
+}
+
+static ExperienceEntry* mapExperience(size_t first, size_t *total) {
+
+    // Returns the entries of the log from index first onwards, if there are any
+    ExperienceEntry *entries = NULL;
+
+#if defined(_WIN32) || defined(_WIN64)
+    FILE *fin = fopen(ExperiencePath, "rb");
+    long size;
+
+    if (fin == NULL) return NULL;
+
+    fseek(fin, 0, SEEK_END);
+    size = ftell(fin);
+    *total = size > 16 ? (size - 16) / sizeof(ExperienceEntry) : 0;
+
+    if (*total > first && (entries = malloc((*total - first) * sizeof(ExperienceEntry))) != NULL) {
+        fseek(fin, 16 + first * sizeof(ExperienceEntry), SEEK_SET);
+        *total = first + fread(entries, sizeof(ExperienceEntry), *total - first, fin);
+    }
+
+    fclose(fin);
+#else
+    struct stat st;
+    char *base;
+    int fd = open(ExperiencePath, O_RDONLY);
+
+    if (fd < 0) return NULL;
+
+    // A partial trailing entry, from an interrupted write, is ignored
+    if (fstat(fd, &st) == 0 && st.st_size > 16) {
+        *total = (st.st_size - 16) / sizeof(ExperienceEntry);
+        if (*total > first) {
+            base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) entries = (ExperienceEntry*)(base + 16) + first;
+        }
+    }
+
+    close(fd);
+#endif
+
+    return entries;
+}
+
+static void unmapExperience(ExperienceEntry *entries, size_t first, size_t total) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void) first; (void) total;
+    free(entries);
+#else
+    munmap((char*)(entries - first) - 16, 16 + total * sizeof(ExperienceEntry));
+#endif
+}
+
+static void clearExperienceIndex() {
+    free(Index);
+    Index = NULL;
+    IndexMask = IndexUsed = IndexedEntries = 0;
+}
+
+static ExperienceEntry* probeExperienceIndex(uint64_t key) {
+
+    // Linear probing. Empty slots have no move, which is never recorded
+    size_t i = key & IndexMask;
+    while (Index[i].move != NONE_MOVE && Index[i].key != key)
+        i = (i + 1) & IndexMask;
+    return &Index[i];
+}
+
+static void insertExperienceIndex(const ExperienceEntry *entry) {
+
+    ExperienceEntry *slot, *old = Index;
+    size_t oldSize = old == NULL ? 0 : IndexMask + 1;
+
+    // Keep the Index at most half full, rehashing into one twice the size
+    if (2 * (IndexUsed + 1) > oldSize) {
+
+        Index = calloc(oldSize ? 2 * oldSize : 1024, sizeof(ExperienceEntry));
+        IndexMask = (oldSize ? 2 * oldSize : 1024) - 1;
+        IndexUsed = 0;
+
+        for (size_t i = 0; i < oldSize; i++)
+            if (old[i].move != NONE_MOVE)
+                *probeExperienceIndex(old[i].key) = old[i], IndexUsed++;
+
+        free(old);
+    }
+
+    // Later entries supersede earlier ones for the same position
+    slot = probeExperienceIndex(entry->key);
+    IndexUsed += slot->move == NONE_MOVE;
+    *slot = *entry;
+}
+
+static void updateExperienceIndex() {
+
+    size_t total = 0;
+    ExperienceEntry *entries;
+
+    // The log only grows, so only the entries since the last update are read
+    if ((entries = mapExperience(IndexedEntries, &total)) == NULL) {
+
+        // Unless the file was replaced by a shorter one, in which case we start again
+        if (total < IndexedEntries) {
+            clearExperienceIndex();
+            updateExperienceIndex();
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < total - IndexedEntries; i++)
+        if (entries[i].move != NONE_MOVE)
+            insertExperienceIndex(&entries[i]);
+
+    unmapExperience(entries, IndexedEntries, total);
+    IndexedEntries = total;
+}
+
+void openExperience(char *path) {
+
+    char header[16] = {0};
+    FILE *fin;
+
+    closeExperience();
+
+    // New files are created with just a header. Others must have a valid header
+    if ((fin = fopen(path, "rb")) != NULL) {
+        size_t read = fread(header, 1, sizeof(header), fin);
+        fclose(fin);
+        if (read != 0 && (read != sizeof(header) || memcmp(header, ExperienceMagic, sizeof(header)))) {
+            writerPrintf("info string %s is not an experience file\n", path);
+            return;
+        }
+    }
+
+    if ((ExperienceLog = fopen(path, "ab")) == NULL) {
+        writerPrintf("info string Unable to open experience file %s\n", path);
+        return;
+    }
+
+    if (ftell(ExperienceLog) == 0) {
+        fwrite(ExperienceMagic, 1, sizeof(ExperienceMagic), ExperienceLog);
+        fflush(ExperienceLog);
+    }
+
+    strncpy(ExperiencePath, path, sizeof(ExperiencePath) - 1);
+    clearExperienceIndex();
+
+    RingHead = RingTail = Closing = 0;
+    pthread_create(&Writer, NULL, &experienceWriter, NULL);
+}
+
+void closeExperience() {
+
+    if (ExperienceLog == NULL) return;
+
+    // Let the writer drain the queue before closing the log
+    pthread_mutex_lock(&RingLock);
+    Closing = 1;
+    pthread_cond_signal(&RingSignal);
+    pthread_mutex_unlock(&RingLock);
+
+    pthread_join(Writer, NULL);
+    fclose(ExperienceLog);
+    ExperienceLog = NULL;
+    clearExperienceIndex();
+}
+
+void recordExperience(Board *board, uint16_t move, int value, int depth) {
+
+    ExperienceEntry entry;
+
+    if (ExperienceLog == NULL || depth < EXPERIENCE_DEPTH || move == NONE_MOVE)
+        return;
+
+    memset(&entry, 0, sizeof(ExperienceEntry));
+    entry.key   = board->hash;
+    entry.move  = move;
+    entry.value = value;
+    entry.depth = depth;
+
+    // Never block the search. If the writer has fallen behind, drop the result
+    pthread_mutex_lock(&RingLock);
+
+    if ((RingHead + 1) % EXPERIENCE_RING_SIZE != RingTail) {
+        Ring[RingHead] = entry;
+        RingHead = (RingHead + 1) % EXPERIENCE_RING_SIZE;
+        pthread_cond_signal(&RingSignal);
+    }
+
+    pthread_mutex_unlock(&RingLock);
+}
+
+int preloadExperience(Board *board) {
+
+    Undo undo[1];
+    uint64_t keys[MAX_MOVES + 1];
+    uint16_t moves[MAX_MOVES];
+    int size = 0, nkeys = 0, loaded = 0;
+    ExperienceEntry *entry;
+
+    if (ExperienceLog == NULL)
+        return 0;
+
+    updateExperienceIndex();
+    if (Index == NULL) return 0;
+
+    // We want results for the position itself, and for each of its children
+    keys[nkeys++] = board->hash;
+    genAllLegalMoves(board, moves, &size);
+    for (int i = 0; i < size; i++) {
+        applyMove(board, moves[i], undo);
+        keys[nkeys++] = board->hash;
+        revertMove(board, moves[i], undo);
+    }
+
+    // Results were stored from the root, so no mate adjustments are needed
+    for (int i = 0; i < nkeys; i++) {
+        if ((entry = probeExperienceIndex(keys[i]))->move != NONE_MOVE) {
+            storeTTEntry(entry->key, entry->move, entry->value,
+                         VALUE_NONE, entry->depth, BOUND_EXACT);
+            loaded++;
+        }
+    }
+
+    return loaded;
+}
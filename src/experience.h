@@ -0,0 +1,42 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    EXPERIENCE_RING_SIZE = 256, // Pending writes before results are dropped
+};
+
+struct ExperienceEntry {
+    uint64_t key;
+    uint16_t move;
+    int16_t value;
+    uint8_t depth;
+    uint8_t padding[3];
+};
+
+void openExperience(char *path);
+void closeExperience();
+void recordExperience(Board *board, uint16_t move, int value, int depth);
+int preloadExperience(Board *board);
+
+extern int EXPERIENCE_DEPTH;
@@ -36,6 +36,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #ifndef _WIN32
+#include <dirent.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #endif
@@ -50,6 +51,7 @@
 #define TBMAX_PIECE 254
 #define TBMAX_PAWN 256
 #define HSHMAX 5
+#define TB_INIT_THREADS 8
 
 // for variants where kings can connect and/or captured
 // #define CONNECTED_KINGS
@@ -93,11 +95,21 @@ static struct TBEntry_pawn TB_pawn[TBMAX_PAWN];
 
 static struct TBHashEntry TB_hash[1 << TBHASHBITS][HSHMAX];
 
+// WDL files found when scanning the paths, sorted, without the suffix
+static char **tb_files = NULL;
+static int num_tb_files = 0;
+
+// Entries whose WDL tables are set up in parallel by init_tablebases()
+static struct TBEntry *init_entries[TBMAX_PIECE + TBMAX_PAWN];
+static char init_names[TBMAX_PIECE + TBMAX_PAWN][16];
+static int init_count, init_next;
+
 #define DTZ_ENTRIES 64
 
 static struct DTZTableEntry DTZ_table[DTZ_ENTRIES];
 
 static void init_indices(void);
+static int init_table_wdl(struct TBEntry *entry, char *str);
 static uint64_t calc_key_from_pcs(int *pcs, int mirror);
 static void free_wdl_entry(struct TBEntry *entry);
 static void free_dtz_entry(struct TBEntry *entry);
@@ -226,20 +238,139 @@ static void add_to_hash(struct TBEntry *ptr, uint64 key)
   }
 }
 
+static int tb_name_cmp(const void *a, const void *b)
+{
+  return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void add_tb_file(const char *name, size_t len, int *cap)
+{
+  // Longer names can not be a table we know, and would overflow init_tb()
+  if (len == 0 || len >= 16) return;
+  if (num_tb_files == *cap) {
+    *cap = *cap ? 2 * *cap : 256;
+    tb_files = (char **)realloc(tb_files, *cap * sizeof(char *));
+  }
+  char *copy = (char *)malloc(len + 1);
+  memcpy(copy, name, len);
+  copy[len] = 0;
+  tb_files[num_tb_files++] = copy;
+}
+
+static int has_wdl_suffix(const char *name, size_t len)
+{
+  size_t slen = strlen(WDLSUFFIX);
+  return len > slen && !strcmp(name + len - slen, WDLSUFFIX);
+}
+
+// Read each directory once, instead of trying to open every possible
+// table name in every directory, which is slow on network storage
+static void scan_paths(void)
+{
+  int i, cap = 0;
+  size_t len, slen = strlen(WDLSUFFIX);
+
+  for (i = 0; i < num_tb_files; i++)
+    free(tb_files[i]);
+  num_tb_files = 0;
+
+  for (i = 0; i < num_paths; i++) {
+#ifndef _WIN32
+    DIR *dir = opendir(paths[i]);
+    struct dirent *ent;
+    if (!dir) continue;
+    while ((ent = readdir(dir)) != NULL) {
+      len = strlen(ent->d_name);
+      if (has_wdl_suffix(ent->d_name, len))
+        add_tb_file(ent->d_name, len - slen, &cap);
+    }
+    closedir(dir);
+#else
+    char pattern[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    HANDLE find;
+    snprintf(pattern, sizeof(pattern), "%s\\*" WDLSUFFIX, paths[i]);
+    find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) continue;
+    do {
+      len = strlen(data.cFileName);
+      if (has_wdl_suffix(data.cFileName, len))
+        add_tb_file(data.cFileName, len - slen, &cap);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#endif
+  }
+
+  if (num_tb_files)
+    qsort(tb_files, num_tb_files, sizeof(char *), tb_name_cmp);
+}
+
+static int tb_file_exists(const char *str)
+{
+  return num_tb_files
+      && bsearch(&str, tb_files, num_tb_files, sizeof(char *), tb_name_cmp);
+}
+
+static void *init_table_worker(void *arg)
+{
+  int i;
+  (void)arg;
+  for (;;) {
+    LOCK(TB_MUTEX);
+    i = init_next++;
+    UNLOCK(TB_MUTEX);
+    if (i >= init_count) return NULL;
+    init_entries[i]->ready = init_table_wdl(init_entries[i], init_names[i]);
+  }
+}
+
+// Map and parse the headers of all WDL tables, which is mostly waiting
+// on the storage, so several threads are used to keep it busy
+static void init_tables_parallel(void)
+{
+  int i, j;
+
+  init_next = 0;
+
+#if !defined(TB_NO_THREADS) && !defined(_WIN32)
+  pthread_t threads[TB_INIT_THREADS];
+  int nthreads = 0;
+  for (i = 1; i < TB_INIT_THREADS && i < init_count; i++)
+    if (!pthread_create(&threads[nthreads], NULL, init_table_worker, NULL))
+      nthreads++;
+  init_table_worker(NULL);
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+#else
+  init_table_worker(NULL);
+#endif
+
+  // Tables which could not be read are never probed
+  for (i = 0; i < (1 << TBHASHBITS); i++)
+    for (j = 0; j < HSHMAX; j++)
+      if (TB_hash[i][j].ptr && !TB_hash[i][j].ptr->ready)
+        TB_hash[i][j].key = 0ULL;
+
+  TB_LARGEST = TB_NUM_TABLES = 0;
+  for (i = 0; i < init_count; i++) {
+    if (!init_entries[i]->ready) continue;
+    TB_NUM_TABLES++;
+    if (init_entries[i]->num > TB_LARGEST)
+      TB_LARGEST = init_entries[i]->num;
+  }
+}
+
 static char pchr[] = {'K', 'Q', 'R', 'B', 'N', 'P'};
 
 static void init_tb(char *str)
 {
-  FD fd;
   struct TBEntry *entry;
   int i, j, pcs[16];
   uint64 key, key2;
   int color;
   char *s;
 
-  fd = open_tb(str, WDLSUFFIX);
-  if (fd == FD_ERR) return;
-  close_tb(fd);
+  if (!tb_file_exists(str)) return;
 
   for (i = 0; i < 16; i++)
     pcs[i] = 0;
@@ -291,9 +422,6 @@ static void init_tb(char *str)
     entry->num += pcs[i];
   entry->symmetric = (key == key2);
   entry->has_pawns = (pcs[TB_WPAWN] + pcs[TB_BPAWN] > 0);
-  if (entry->num > TB_LARGEST)
-    TB_LARGEST = entry->num;
-
   if (entry->has_pawns) {
     struct TBEntry_pawn *ptr = (struct TBEntry_pawn *)entry;
     ptr->pawns[0] = pcs[TB_WPAWN];
@@ -319,6 +447,9 @@ static void init_tb(char *str)
   }
   add_to_hash(entry, key);
   if (key2 != key) add_to_hash(entry, key2);
+
+  init_entries[init_count] = entry;
+  strcpy(init_names[init_count++], str);
 }
 
 void init_tablebases(const char *path)
@@ -347,7 +478,11 @@ void init_tablebases(const char *path)
   }
 
   const char *p = path;
-  if (strlen(p) == 0 || !strcmp(p, "<empty>")) return;
+  if (strlen(p) == 0 || !strcmp(p, "<empty>")) {
+    TB_LARGEST = TB_NUM_TABLES = 0;
+    num_paths = 0;
+    return;
+  }
   path_string = (char *)malloc(strlen(p) + 1);
   strcpy(path_string, p);
   num_paths = 0;
@@ -369,7 +504,10 @@ void init_tablebases(const char *path)
   LOCK_INIT(TB_MUTEX);
 
   TBnum_piece = TBnum_pawn = 0;
-  TB_LARGEST = 0;
+  TB_LARGEST = TB_NUM_TABLES = 0;
+  init_count = 0;
+
+  scan_paths();
 
   for (i = 0; i < (1 << TBHASHBITS); i++)
     for (j = 0; j < HSHMAX; j++) {
@@ -435,7 +573,7 @@ void init_tablebases(const char *path)
 	  init_tb(str);
 	}
 
-  printf("info string found %d tablebases\n", TBnum_piece + TBnum_pawn);
+  init_tables_parallel();
 }
 
 static const signed char offdiag[] = {
@@ -1323,6 +1461,16 @@ static struct PairsData *setup_pairs(unsigned char *data, uint64 tb_size, uint64
     d->base[i] <<= 32 - (min_len + i);
 #endif
 
+#if !defined(DECOMP64) && defined(USE_PEXT)
+  // A code with z leading zeros is below 2^(32-z), so it can not have
+  // any of the lengths whose base is at least that large
+  int j = 0;
+  for (i = 0; i <= 32; i++) {
+    while ((uint64)d->base[j] >= (1ULL << (32 - i))) j++;
+    d->lz_len[i] = (ubyte)(min_len + j);
+  }
+#endif
+
   d->offset -= d->min_len;
 
   return d;
@@ -1581,6 +1729,28 @@ static ubyte decompress_pairs(struct PairsData *d, uint64 idx)
       code |= ((uint64)(internal_bswap32(data))) << bitcnt;
     }
   }
+#elif defined(USE_PEXT)
+  // The top 32 bits of buf hold the next code, followed by avail - 32
+  // further bits. A single refill keeps at least 32 bits available, and
+  // reads the block in the same order as the decoder below. Counting the
+  // leading zeros skips straight to the shortest possible code length
+  uint64 buf = (uint64)internal_bswap32(*ptr++) << 32;
+  int avail = 32;
+  (void)bitcnt;
+  for (;;) {
+    uint32 code = (uint32)(buf >> 32);
+    int l = code ? d->lz_len[__builtin_clz(code)] : d->lz_len[32];
+    while (code < base[l]) l++;
+    sym = offset[l] + ((code - base[l]) >> (32 - l));
+    if (litidx < (int)symlen[sym] + 1) break;
+    litidx -= (int)symlen[sym] + 1;
+    buf <<= l;
+    avail -= l;
+    if (avail < 32) {
+      buf |= (uint64)internal_bswap32(*ptr++) << (32 - avail);
+      avail += 32;
+    }
+  }
 #else
   uint32 next = 0;
   uint32 data = *ptr++;
@@ -86,6 +86,9 @@ struct PairsData {
   int blocksize;
   int idxbits;
   int min_len;
+#ifdef USE_PEXT
+  ubyte lz_len[33]; // shortest code length for each leading zero count
+#endif
   base_t base[1]; // C++ complains about base[]...
 };
 
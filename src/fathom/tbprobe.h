@@ -160,6 +160,11 @@ extern unsigned tb_probe_root_impl(
  */
 extern unsigned TB_LARGEST;
 
+/*
+ * The number of tablebase files which were found and could be read.
+ */
+extern unsigned TB_NUM_TABLES;
+
 /*
  * Initialize the tablebase.
  *
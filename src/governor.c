@@ -0,0 +1,112 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // For syscall() and SYS_gettid
+#endif
+
+#include <stdint.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+#endif
+
+#include "governor.h"
+#include "thread.h"
+#include "time.h"
+#include "types.h"
+
+
+int CPU_LIMIT = 100; // Set by UCI options, percent of the Threads' total CPU
+
+int LOW_PRIORITY; // Set by UCI options
+
+extern volatile int ABORT_SIGNAL; // Defined by Search.c
+
+extern volatile int IS_WARMING; // Defined by Search.c
+
+
+void governorNewSearch(Thread* threads) {
+
+    const int nthreads = threads[0].nthreads;
+
+    // Total CPU budget for the search, measured in whole cores
+    double budget = nthreads * CPU_LIMIT / 100.0;
+
+    // The main thread drives time management and reporting, so it is only
+    // throttled once the budget can no longer afford a single full core
+    threads[0].duty = MIN(1.0, budget);
+
+    // Helpers share whatever remains of the budget evenly
+    for (int i = 1; i < nthreads; i++)
+        threads[i].duty = MAX(0.0, MIN(1.0, (budget - 1.0) / (nthreads - 1)));
+}
+
+void governorStartThread(Thread* thread) {
+
+    // Start the first duty cycle once the Thread is actually running
+    thread->slicestart = getPreciseTime();
+
+    // The priority is never restored. Each go and analyse searches in
+    // threads created for it, and a warming search only follows the go
+    // in its own thread. The command line tools search in the main
+    // thread, but have no way to set LowPriority and never warm.
+    // Warming searches only fill the tables, so they always yield
+    if (!LOW_PRIORITY && !IS_WARMING) return;
+
+#if defined(_WIN32) || defined(_WIN64)
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+}
+
+void governThread(Thread* thread) {
+
+    uint64_t busy, idle, wake;
+
+    // Nothing to do for a Thread allowed to use a full core
+    if (thread->duty >= 1.0) return;
+
+    // Keep searching until this Thread has used its share of the slice
+    busy = getPreciseTime() - thread->slicestart;
+    if (busy < thread->duty * GOVERNOR_SLICE_MS * 1000000ull) return;
+
+    // Sleep for the remainder of the slice, in proportion to the time that was
+    // actually spent searching. Helpers without a budget sleep until the abort
+    idle = thread->duty > 0.0 ? (uint64_t)(busy * (1.0 - thread->duty) / thread->duty) : UINT64_MAX;
+    wake = getPreciseTime() + MIN(idle, UINT64_MAX / 2);
+
+    // Sleep in small steps, so that an abort is not delayed
+    while (!ABORT_SIGNAL && getPreciseTime() < wake)
+        sleepMilliseconds(1);
+
+    thread->slicestart = getPreciseTime();
+}
+
+int governorDuty(Thread* thread) {
+    return (int)(100.0 * thread->duty + 0.5);
+}
@@ -0,0 +1,36 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    GOVERNOR_SLICE_MS = 20, // Length of a duty cycle for a throttled Thread
+};
+
+void governorNewSearch(Thread* threads);
+void governorStartThread(Thread* thread);
+void governThread(Thread* thread);
+int governorDuty(Thread* thread);
+
+extern int CPU_LIMIT;
+extern int LOW_PRIORITY;
@@ -16,6 +16,7 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -25,6 +26,83 @@
 #include "thread.h"
 #include "types.h"
 
+#ifdef COMPACT_TABLES
+
+// Compact builds keep history as signed 8-bit codes. Each code stands for a
+// value on a log scale, giving fine steps for the small scores which decide
+// most orderings, while still reaching the HISTORY_MAX saturation point
+
+static int HistoryDecode[2 * HISTORY_CODE_MAX + 1];
+
+void initHistory() {
+
+    const double base = pow(HISTORY_MAX / 16.0 + 1.0, 1.0 / HISTORY_CODE_MAX);
+
+    for (int code = 0; code <= HISTORY_CODE_MAX; code++) {
+        int value = (int)round(16.0 * (pow(base, code) - 1.0));
+        HistoryDecode[HISTORY_CODE_MAX + code] =  value;
+        HistoryDecode[HISTORY_CODE_MAX - code] = -value;
+    }
+}
+
+static int decodeHistory(HistoryEntry entry) {
+    return HistoryDecode[HISTORY_CODE_MAX + MAX(-HISTORY_CODE_MAX, entry)];
+}
+
+static HistoryEntry encodeHistory(int value) {
+
+    static _Thread_local uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+    int lower = -HISTORY_CODE_MAX, upper = HISTORY_CODE_MAX, below, above;
+
+    // Find the first code at or above the value, as the values are sorted
+    while (lower < upper) {
+        int middle = lower + (upper - lower) / 2;
+        if (HistoryDecode[HISTORY_CODE_MAX + middle] < value) lower = middle + 1;
+        else upper = middle;
+    }
+
+    if (   lower == -HISTORY_CODE_MAX
+        || HistoryDecode[HISTORY_CODE_MAX + lower] == value)
+        return (HistoryEntry)lower;
+
+    // Rounding to the nearest code would drop every update of less than half
+    // a step. Instead, round to either neighbour with a chance in proportion
+    // to how near the value is, so that updates of any size count on average.
+    // The xorshift keeps the choices, and so the bench, deterministic
+    below = HistoryDecode[HISTORY_CODE_MAX + lower - 1];
+    above = HistoryDecode[HISTORY_CODE_MAX + lower];
+
+    seed ^= seed >> 12; seed ^= seed << 25; seed ^= seed >> 27;
+
+    return (HistoryEntry)((int)((seed * 2685821657736338717ull >> 33) % (above - below))
+                          < value - below ? lower : lower - 1);
+}
+
+#else
+
+void initHistory() {}
+
+static int decodeHistory(HistoryEntry entry) {
+    return entry;
+}
+
+static HistoryEntry encodeHistory(int value) {
+    return (HistoryEntry)value;
+}
+
+#endif
+
+static void applyHistoryDelta(HistoryEntry *entry, int delta) {
+
+    int value = decodeHistory(*entry);
+
+    delta = MAX(-400, MIN(400, delta));
+
+    value += 32 * delta - value * abs(delta) / 512;
+    *entry = encodeHistory(value);
+}
+
 int getHistoryScore(Thread *thread, uint16_t move) {
 
     int colour = thread->board.turn;
@@ -35,12 +113,11 @@ int getHistoryScore(Thread *thread, uint16_t move) {
     assert(0 <= from && from < SQUARE_NB);
     assert(0 <= to && to < SQUARE_NB);
 
-    return thread->history[colour][from][to];
+    return decodeHistory(thread->history[colour][from][to]);
 }
 
 void updateHistory(Thread *thread, uint16_t move, int delta) {
 
-    int entry;
     int colour = thread->board.turn;
     int from  = MoveFrom(move);
     int to    = MoveTo(move);
@@ -49,117 +126,136 @@ void updateHistory(Thread *thread, uint16_t move, int delta) {
     assert(0 <= from && from < SQUARE_NB);
     assert(0 <= to && to < SQUARE_NB);
 
-    delta = MAX(-400, MIN(400, delta));
-
-    entry = thread->history[colour][from][to];
-    entry += 32 * delta - entry * abs(delta) / 512;
-    thread->history[colour][from][to] = entry;
+    applyHistoryDelta(&thread->history[colour][from][to], delta);
 }
 
 int getCMHistoryScore(Thread *thread, int height, uint16_t move) {
 
-    int to1, to2, piece1, piece2;
-    uint16_t previous = thread->moveStack[height-1];
+    int to, piece;
+    ContinuationTable *table = thread->stack[height-1].cmhistory;
 
     // Check for root position or null moves
-    if (previous == NULL_MOVE || previous == NONE_MOVE)
+    if (table == NULL)
         return 0;
 
-    to1    = MoveTo(previous);
-    piece1 = pieceType(thread->board.squares[to1]);
-
-    to2    = MoveTo(move);
-    piece2 = pieceType(thread->board.squares[MoveFrom(move)]);
+    to    = MoveTo(move);
+    piece = pieceType(thread->board.squares[MoveFrom(move)]);
 
-    assert(0 <= piece1 && piece1 < PIECE_NB);
-    assert(0 <= to1 && to1 < SQUARE_NB);
-    assert(0 <= piece2 && piece2 < PIECE_NB);
-    assert(0 <= to2 && to2 < SQUARE_NB);
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
 
-    return thread->cmhistory[piece1][to1][piece2][to2];
+    return decodeHistory((*table)[piece][to]);
 }
 
 void updateCMHistory(Thread *thread, int height, uint16_t move, int delta) {
 
-    int entry, to1, to2, piece1, piece2;
-    uint16_t previous = thread->moveStack[height-1];
+    int to, piece;
+    ContinuationTable *table = thread->stack[height-1].cmhistory;
 
     // Check for root position or null moves
-    if (previous == NULL_MOVE || previous == NONE_MOVE)
+    if (table == NULL)
         return;
 
-    to1    = MoveTo(previous);
-    piece1 = pieceType(thread->board.squares[to1]);
-
-    to2    = MoveTo(move);
-    piece2 = pieceType(thread->board.squares[MoveFrom(move)]);
-
-    assert(0 <= piece1 && piece1 < PIECE_NB);
-    assert(0 <= to1 && to1 < SQUARE_NB);
-    assert(0 <= piece2 && piece2 < PIECE_NB);
-    assert(0 <= to2 && to2 < SQUARE_NB);
+    to    = MoveTo(move);
+    piece = pieceType(thread->board.squares[MoveFrom(move)]);
 
-    delta = MAX(-400, MIN(400, delta));
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
 
-    entry = thread->cmhistory[piece1][to1][piece2][to2];
-    entry += 32 * delta - entry * abs(delta) / 512;
-    thread->cmhistory[piece1][to1][piece2][to2] = entry;
+    applyHistoryDelta(&(*table)[piece][to], delta);
 }
 
 int getFUHistoryScore(Thread *thread, int height, uint16_t move) {
 
-    int to1, to2, piece1, piece2;
-    uint16_t following = thread->moveStack[height-2];
+    int to, piece;
+    ContinuationTable *table = thread->stack[height-2].fuhistory;
 
     // Check for root position or null moves
-    if (following == NULL_MOVE || following == NONE_MOVE)
+    if (table == NULL)
         return 0;
 
-    to1    = MoveTo(following);
-    piece1 = thread->pieceStack[height-2];
-
-    to2    = MoveTo(move);
-    piece2 = pieceType(thread->board.squares[MoveFrom(move)]);
+    to    = MoveTo(move);
+    piece = pieceType(thread->board.squares[MoveFrom(move)]);
 
-    assert(0 <= piece1 && piece1 < PIECE_NB);
-    assert(0 <= to1 && to1 < SQUARE_NB);
-    assert(0 <= piece2 && piece2 < PIECE_NB);
-    assert(0 <= to2 && to2 < SQUARE_NB);
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
 
-    return thread->fuhistory[piece1][to1][piece2][to2];
+    return decodeHistory((*table)[piece][to]);
 }
 
 void updateFUHistory(Thread *thread, int height, uint16_t move, int delta) {
 
-    int entry, to1, to2, piece1, piece2;
-    uint16_t following = thread->moveStack[height-2];
+    int to, piece;
+    ContinuationTable *table = thread->stack[height-2].fuhistory;
 
     // Check for root position or null moves
-    if (following == NULL_MOVE || following == NONE_MOVE)
+    if (table == NULL)
         return;
 
-    to1    = MoveTo(following);
-    piece1 = thread->pieceStack[height-2];
+    to    = MoveTo(move);
+    piece = pieceType(thread->board.squares[MoveFrom(move)]);
 
-    to2    = MoveTo(move);
-    piece2 = pieceType(thread->board.squares[MoveFrom(move)]);
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
 
-    assert(0 <= piece1 && piece1 < PIECE_NB);
-    assert(0 <= to1 && to1 < SQUARE_NB);
-    assert(0 <= piece2 && piece2 < PIECE_NB);
-    assert(0 <= to2 && to2 < SQUARE_NB);
+    applyHistoryDelta(&(*table)[piece][to], delta);
+}
 
-    delta = MAX(-400, MIN(400, delta));
+int getGainScore(Thread *thread, uint16_t move) {
+
+    int entry;
+    int colour = thread->board.turn;
+    int from   = MoveFrom(move);
+    int to     = MoveTo(move);
+    int piece  = pieceType(thread->board.squares[from]);
+
+    assert(0 <= colour && colour < COLOUR_NB);
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= from && from < SQUARE_NB);
+    assert(0 <= to && to < SQUARE_NB);
+
+    // Moves which were never seen have no gain to speak of
+    entry = thread->gains[colour][piece][from][to];
+    return entry ? entry - GAIN_OFFSET : 0;
+}
+
+void updateGainHistory(Thread *thread, int height, int eval) {
+
+    int entry, delta, colour, from, to, piece;
+    const SearchStack *ss = &thread->stack[height-1];
+
+    // Only learn from normal quiet moves. This skips the root, null moves,
+    // captures, and the special moves which have no single moving piece
+    if (   ss->move == NULL_MOVE
+        || ss->move == NONE_MOVE
+        || MoveType(ss->move) != NORMAL_MOVE
+        || ss->undo.capturePiece != EMPTY)
+        return;
+
+    colour = !thread->board.turn;
+    from   = MoveFrom(ss->move);
+    to     = MoveTo(ss->move);
+    piece  = ss->piece;
+
+    assert(0 <= colour && colour < COLOUR_NB);
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= from && from < SQUARE_NB);
+    assert(0 <= to && to < SQUARE_NB);
+
+    // Change in the static eval, from the view of the side which moved
+    delta = MAX(-GAIN_MAX, MIN(GAIN_MAX, -eval - ss->eval));
 
-    entry = thread->fuhistory[piece1][to1][piece2][to2];
-    entry += 32 * delta - entry * abs(delta) / 512;
-    thread->fuhistory[piece1][to1][piece2][to2] = entry;
+    // Track the largest gain seen, slowly forgetting older maximums. The decay
+    // stops at zero, so a negative maximum is one the move has actually seen
+    entry = thread->gains[colour][piece][from][to];
+    if (entry) delta = MAX(delta, entry - GAIN_OFFSET - (entry > GAIN_OFFSET));
+    thread->gains[colour][piece][from][to] = delta + GAIN_OFFSET;
 }
 
 uint16_t getCounterMove(Thread *thread, int height) {
 
     int colour, to, piece;
-    const uint16_t previous = thread->moveStack[height-1];
+    const uint16_t previous = thread->stack[height-1].move;
 
     // Check for root position or null moves
     if (previous == NULL_MOVE || previous == NONE_MOVE)
@@ -167,7 +263,7 @@ uint16_t getCounterMove(Thread *thread, int height) {
 
     colour = !thread->board.turn;
     to     = MoveTo(previous);
-    piece  = pieceType(thread->board.squares[to]);
+    piece  = thread->stack[height-1].piece;
 
     assert(0 <= colour && colour < COLOUR_NB);
     assert(0 <= piece && piece < PIECE_NB);
@@ -179,7 +275,7 @@ uint16_t getCounterMove(Thread *thread, int height) {
 void updateCounterMove(Thread *thread, int height, uint16_t move) {
 
     int colour, to, piece;
-    const uint16_t previous = thread->moveStack[height-1];
+    const uint16_t previous = thread->stack[height-1].move;
 
     // Check for root position or null moves
     if (previous == NULL_MOVE || previous == NONE_MOVE)
@@ -187,7 +283,7 @@ void updateCounterMove(Thread *thread, int height, uint16_t move) {
 
     colour = !thread->board.turn;
     to     = MoveTo(previous);
-    piece  = pieceType(thread->board.squares[to]);
+    piece  = thread->stack[height-1].piece;
 
     assert(0 <= colour && colour < COLOUR_NB);
     assert(0 <= piece && piece < PIECE_NB);
@@ -22,6 +22,15 @@
 
 #include "types.h"
 
+enum {
+    HISTORY_MAX      = 16384, // Saturation point of the update formula
+    HISTORY_CODE_MAX =   127, // Largest code of a compact history entry
+    GAIN_MAX         =  1000, // Largest eval gain tracked in either direction
+    GAIN_OFFSET      =  1024, // Stored with the gains, so that zero is unseen
+};
+
+void initHistory();
+
 int getHistoryScore(Thread *thread, uint16_t move);
 void updateHistory(Thread *thread, uint16_t move, int delta);
 
@@ -31,5 +40,8 @@ void updateCMHistory(Thread *thread, int height, uint16_t move, int delta);
 int getFUHistoryScore(Thread *thread, int height, uint16_t move);
 void updateFUHistory(Thread *thread, int height, uint16_t move, int delta);
 
+int getGainScore(Thread *thread, uint16_t move);
+void updateGainHistory(Thread *thread, int height, int eval);
+
 uint16_t getCounterMove(Thread *thread, int height);
 void updateCounterMove(Thread *thread, int height, uint16_t move);
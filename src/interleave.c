@@ -0,0 +1,234 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "interleave.h"
+#include "thread.h"
+#include "time.h"
+#include "transposition.h"
+#include "types.h"
+#include "uci.h"
+
+extern volatile int ABORT_SIGNAL; // For killing active search
+
+// One OS thread drives several independent searches, switching to the next one
+// whenever a search is about to probe the Transposition Table. The probe is
+// prefetched first, so that the memory latency of a large Table is spent making
+// progress elsewhere, instead of stalling. Run as "interleave [depth] [width]
+// [megabytes]", which searches the benchmark positions first one at a time, and
+// then width at a time, reporting the change in throughput between the two.
+// The search only checks for a fiber in builds made with "make interleave", so
+// that the normal search carries no trace of this tool.
+
+#if defined(INTERLEAVE) && defined(__x86_64__) && defined(__ELF__)
+
+#define FIBERS_SUPPORTED
+
+// Push the callee-saved registers, save the stack pointer to *save, and then
+// resume the fiber whose stack pointer is load, by popping its registers. All
+// other registers are already clobbered from the view of the calling function
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".globl etherealSwitchFiber\n"
+    ".hidden etherealSwitchFiber\n"
+    ".type etherealSwitchFiber, @function\n"
+    "etherealSwitchFiber:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size etherealSwitchFiber, .-etherealSwitchFiber\n"
+);
+
+void etherealSwitchFiber(void **save, void *load);
+
+static void *SchedulerContext; // Stack pointer of the scheduling loop
+static SearchFiber *Starting;  // Fiber being entered for the first time
+
+#endif
+
+static Limits *FiberLimits;
+static int NextPosition;       // Benchmarks which are yet to be handed out
+
+static void searchPositions(SearchFiber *fiber, Limits *limits) {
+
+    // Take positions from the shared list until none are left. Each starts
+    // from empty history tables, so that the positions are searched alike in
+    // both passes, no matter which Thread happened to pick them up
+    while (strcmp(Benchmarks[NextPosition], "")) {
+        resetThreadPool(fiber->thread);
+        fiber->nodes += searchBenchmarkPosition(fiber->thread, Benchmarks[NextPosition++], limits);
+    }
+}
+
+#ifdef FIBERS_SUPPORTED
+
+static void fiberMain() {
+
+    SearchFiber *fiber = Starting;
+
+    searchPositions(fiber, FiberLimits);
+
+    // Hand control back for good, the scheduler never resumes us
+    fiber->finished = 1;
+    etherealSwitchFiber(&fiber->context, SchedulerContext);
+}
+
+static void initFiberContext(SearchFiber *fiber) {
+
+    uintptr_t top = ((uintptr_t)fiber->stack + FIBER_STACK_SIZE) & ~(uintptr_t)15;
+    uintptr_t *sp = (uintptr_t*)top;
+
+    // The first switch pops six zeroed registers, and then returns into
+    // fiberMain, which sees a null return address on an aligned stack
+    *--sp = 0;
+    *--sp = (uintptr_t)fiberMain;
+    for (int i = 0; i < 6; i++) *--sp = 0;
+
+    fiber->context = sp;
+}
+
+static void runFibers(SearchFiber *fibers, int width) {
+
+    int active = width;
+
+    for (int i = 0; i < width; i++)
+        initFiberContext(&fibers[i]);
+
+    // Round robin over the unfinished fibers. Each runs until its next
+    // Table probe, and the first entry into a fiber starts its search
+    while (active) {
+        for (int i = 0; i < width; i++) {
+            if (fibers[i].finished) continue;
+            Starting = &fibers[i];
+            etherealSwitchFiber(&SchedulerContext, fibers[i].context);
+            active -= fibers[i].finished;
+        }
+    }
+}
+
+void yieldSearchFiber(SearchFiber *fiber, uint64_t hash) {
+    prefetchTTEntry(hash);
+    etherealSwitchFiber(&fiber->context, SchedulerContext);
+}
+
+#else
+
+static void runFibers(SearchFiber *fibers, int width) {
+
+    // Without a way to switch stacks, the searches simply run in turn
+    for (int i = 0; i < width; i++)
+        searchPositions(&fibers[i], FiberLimits);
+}
+
+void yieldSearchFiber(SearchFiber *fiber, uint64_t hash) {
+    (void) fiber; prefetchTTEntry(hash);
+}
+
+#endif
+
+static uint64_t runPass(SearchFiber *fibers, int width, int interleaved) {
+
+    uint64_t nodes = 0ull;
+
+    // Every pass starts from an empty Table and the first position
+    clearTT(); updateTT();
+    NextPosition = 0;
+    ABORT_SIGNAL = 0;
+
+    for (int i = 0; i < width; i++) {
+        fibers[i].thread->fiber = interleaved ? &fibers[i] : NULL;
+        fibers[i].nodes = 0ull;
+        fibers[i].finished = 0;
+    }
+
+    if (interleaved) runFibers(fibers, width);
+    else searchPositions(&fibers[0], FiberLimits);
+
+    for (int i = 0; i < width; i++)
+        nodes += fibers[i].nodes;
+
+    return nodes;
+}
+
+void runInterleavedBenchmark(int depth, int width) {
+
+    Limits limits;
+    SearchFiber fibers[FIBER_MAX_WIDTH];
+    double start, elapsed[2];
+    uint64_t nodes[2];
+    int nps[2];
+
+    width = MAX(1, MIN(FIBER_MAX_WIDTH, width));
+
+    #if !defined(INTERLEAVE)
+        printf("Interleaving requires a build from \"make interleave\"\n");
+        return;
+    #elif !defined(FIBERS_SUPPORTED)
+        printf("Interleaving is not supported on this platform\n");
+    #endif
+
+    // Only the depth limit is used, as with the normal benchmark
+    memset(&limits, 0, sizeof(Limits));
+    limits.limitedByDepth = 1;
+    limits.depthLimit     = depth == 0 ? 13 : depth;
+    limits.start          = getRealTime();
+    FiberLimits = &limits;
+
+    // Each search has its own Thread, with its own tables, and its own stack
+    for (int i = 0; i < width; i++) {
+        fibers[i].thread = createThreadPool(1);
+        fibers[i].thread->index = 1 + i; // Numbered as helpers, which never report
+        fibers[i].thread->duty = 1.0;
+        fibers[i].stack = malloc(FIBER_STACK_SIZE);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        start = getRealTime();
+        nodes[pass] = runPass(fibers, width, pass);
+        elapsed[pass] = MAX(1.0, getRealTime() - start);
+        nps[pass] = (int)(nodes[pass] / (elapsed[pass] / 1000.0));
+    }
+
+    printf("Sequential  : %"PRIu64" nodes %dms %d nps\n", nodes[0], (int)elapsed[0], nps[0]);
+    printf("Interleaved : %"PRIu64" nodes %dms %d nps (width %d)\n", nodes[1], (int)elapsed[1], nps[1], width);
+    printf("Gain        : %+.1f%%\n", 100.0 * (nps[1] - nps[0]) / nps[0]);
+
+    for (int i = 0; i < width; i++) {
+        free(fibers[i].thread);
+        free(fibers[i].stack);
+    }
+}
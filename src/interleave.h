@@ -0,0 +1,39 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    FIBER_STACK_SIZE = 8 << 20, // Matches the usual default for a pthread
+    FIBER_MAX_WIDTH  = 64,
+};
+
+struct SearchFiber {
+    void *context;   // Saved stack pointer while switched out
+    char *stack;
+    Thread *thread;
+    uint64_t nodes;
+    int finished;
+};
+
+void yieldSearchFiber(SearchFiber *fiber, uint64_t hash);
+void runInterleavedBenchmark(int depth, int width);
@@ -0,0 +1,108 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "governor.h"
+#include "monitor.h"
+#include "thread.h"
+#include "time.h"
+#include "types.h"
+#include "writer.h"
+
+
+int MONITOR_INTERVAL; // Set by UCI options, in milliseconds
+
+extern volatile int IS_WARMING; // Defined by Search.c
+
+
+void startMonitor(Monitor* monitor, Thread* threads) {
+
+    monitor->threads = threads;
+    monitor->stop    = 1;
+
+    // Nothing to do unless the monitor has been enabled, and
+    // warming searches are not reported to the interface
+    if (MONITOR_INTERVAL <= 0 || IS_WARMING) return;
+
+    // Node counts of the previous sample, to compute a per-Thread speed
+    monitor->nodes = calloc(threads[0].nthreads, sizeof(uint64_t));
+    monitor->last  = getRealTime();
+    monitor->stop  = 0;
+
+    pthread_create(&monitor->pthread, NULL, &monitorThreads, monitor);
+}
+
+void stopMonitor(Monitor* monitor) {
+
+    if (monitor->stop) return;
+
+    monitor->stop = 1;
+    pthread_join(monitor->pthread, NULL);
+    free(monitor->nodes);
+}
+
+void* monitorThreads(void* vmonitor) {
+
+    Monitor* const monitor = (Monitor*) vmonitor;
+    int slept = 0;
+
+    // Sleep in small steps, so that the end of a search is not delayed
+    while (!monitor->stop) {
+
+        sleepMilliseconds(MIN(10, MONITOR_INTERVAL));
+
+        if ((slept += MIN(10, MONITOR_INTERVAL)) >= MONITOR_INTERVAL)
+            reportThreads(monitor), slept = 0;
+    }
+
+    return NULL;
+}
+
+void reportThreads(Monitor* monitor) {
+
+    Thread* const threads = monitor->threads;
+    double now = getRealTime(), elapsed = MAX(1, now - monitor->last);
+
+    for (int i = 0; i < threads[0].nthreads; i++) {
+
+        // Sample the counters once, as the Thread keeps on searching
+        uint64_t nodes  = threads[i].nodes;
+        uint64_t probes = threads[i].ttprobes;
+        uint64_t hits   = threads[i].tthits;
+
+        int nps       = (int)(1000 * (nodes - monitor->nodes[i]) / elapsed);
+        double hitpct = 100.0 * hits / MAX(1, probes);
+        int lastcheck = (int)(now - threads[i].lastcheck);
+
+        // A Thread which has not polled the clock recently may be stalled
+        writerPrintfInfo("info string thread %d depth %d seldepth %d nodes %"PRIu64" "
+                         "nps %d tthits %.1f%% lastcheck %dms duty %d%%\n",
+                         i, threads[i].depth, threads[i].seldepth, nodes,
+                         nps, hitpct, MAX(0, lastcheck), governorDuty(&threads[i]));
+
+        monitor->nodes[i] = nodes;
+    }
+
+
+    monitor->last = now;
+}
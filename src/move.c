@@ -27,6 +27,7 @@
 #include "masks.h"
 #include "move.h"
 #include "movegen.h"
+#include "numa.h"
 #include "psqt.h"
 #include "thread.h"
 #include "types.h"
@@ -36,11 +37,13 @@
 int apply(Thread *thread, Board *board, uint16_t move, int height) {
 
     int legal;
-    Undo *undo = &thread->undoStack[height];
+    SearchStack *ss = &thread->stack[height];
+    Undo *undo = &ss->undo;
 
     // NULL moves are only tried when legal
     if (move == NULL_MOVE) {
-        thread->moveStack[height] = NULL_MOVE;
+        ss->move = NULL_MOVE;
+        ss->cmhistory = ss->fuhistory = NULL;
         applyNullMove(board, undo);
         return 1;
     }
@@ -50,10 +53,13 @@ int apply(Thread *thread, Board *board, uint16_t move, int height) {
     legal = isNotInCheck(board, !board->turn);
     if (!legal) revertMove(board, move, undo);
 
-    // Track each move and which piece type made it throughout the tree
+    // Track each move and which piece type made it throughout the tree,
+    // as well as the continuation histories which follow from the move
     if (legal) {
-        thread->moveStack[height] = move;
-        thread->pieceStack[height] = pieceType(board->squares[MoveTo(move)]);
+        ss->move = move;
+        ss->piece = pieceType(board->squares[MoveTo(move)]);
+        ss->cmhistory = &thread->cmhistory[ss->piece][MoveTo(move)];
+        ss->fuhistory = &thread->fuhistory[ss->piece][MoveTo(move)];
     }
 
     // Let the search know to skip this move
@@ -82,9 +88,9 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
     board->fiftyMoveRule += 1;
 
     // Always update for turn and changes to enpass square
-    board->hash ^= ZobristTurnKey;
+    board->hash ^= Tables->ZobristTurnKey;
     if (board->epSquare != -1)
-        board->hash ^= ZobristEnpassKeys[fileOf(board->epSquare)];
+        board->hash ^= Tables->ZobristEnpassKeys[fileOf(board->epSquare)];
 
     // Run the correct move function
     table[MoveType(move) >> 12](board, move, undo);
@@ -124,24 +130,24 @@ void applyNormalMove(Board *board, uint16_t move, Undo *undo) {
     board->squares[to]   = fromPiece;
     undo->capturePiece   = toPiece;
 
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
     board->castleRights &= CastleMask[from] & CastleMask[to];
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
 
-    board->psqtmat += PSQT[fromPiece][to]
-                   -  PSQT[fromPiece][from]
-                   -  PSQT[toPiece][to];
+    board->psqtmat += Tables->PSQT[fromPiece][to]
+                   -  Tables->PSQT[fromPiece][from]
+                   -  Tables->PSQT[toPiece][to];
 
-    board->hash    ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[fromPiece][to]
-                   ^  ZobristKeys[toPiece][to];
+    board->hash    ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[fromPiece][to]
+                   ^  Tables->ZobristKeys[toPiece][to];
 
     if (fromType == PAWN || fromType == KING)
-        board->pkhash ^= ZobristKeys[fromPiece][from]
-                      ^  ZobristKeys[fromPiece][to];
+        board->pkhash ^= Tables->ZobristKeys[fromPiece][from]
+                      ^  Tables->ZobristKeys[fromPiece][to];
 
     if (toType == PAWN || toType == KING)
-        board->pkhash ^= ZobristKeys[toPiece][to];
+        board->pkhash ^= Tables->ZobristKeys[toPiece][to];
 
     if (fromType == PAWN && (to ^ from) == 16) {
 
@@ -151,7 +157,7 @@ void applyNormalMove(Board *board, uint16_t move, Undo *undo) {
                                   & (board->turn == WHITE ? RANK_4 : RANK_5);
         if (enemyPawns) {
             board->epSquare = board->turn == WHITE ? from + 8 : from - 8;
-            board->hash ^= ZobristEnpassKeys[fileOf(from)];
+            board->hash ^= Tables->ZobristEnpassKeys[fileOf(from)];
         }
     }
 }
@@ -179,22 +185,22 @@ void applyCastleMove(Board *board, uint16_t move, Undo *undo) {
     board->squares[rFrom] = EMPTY;
     board->squares[rTo]   = rFromPiece;
 
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
     board->castleRights &= CastleMask[from];
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
 
-    board->psqtmat += PSQT[fromPiece][to]
-                    - PSQT[fromPiece][from]
-                    + PSQT[rFromPiece][rTo]
-                    - PSQT[rFromPiece][rFrom];
+    board->psqtmat += Tables->PSQT[fromPiece][to]
+                    - Tables->PSQT[fromPiece][from]
+                    + Tables->PSQT[rFromPiece][rTo]
+                    - Tables->PSQT[rFromPiece][rFrom];
 
-    board->hash    ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[fromPiece][to]
-                   ^  ZobristKeys[rFromPiece][rFrom]
-                   ^  ZobristKeys[rFromPiece][rTo];
+    board->hash    ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[fromPiece][to]
+                   ^  Tables->ZobristKeys[rFromPiece][rFrom]
+                   ^  Tables->ZobristKeys[rFromPiece][rTo];
 
-    board->pkhash  ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[fromPiece][to];
+    board->pkhash  ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[fromPiece][to];
 
     assert(pieceType(fromPiece) == KING);
 
@@ -223,17 +229,17 @@ void applyEnpassMove(Board *board, uint16_t move, Undo *undo) {
     board->squares[ep]   = EMPTY;
     undo->capturePiece   = enpassPiece;
 
-    board->psqtmat += PSQT[fromPiece][to]
-                    - PSQT[fromPiece][from]
-                    - PSQT[enpassPiece][ep];
+    board->psqtmat += Tables->PSQT[fromPiece][to]
+                    - Tables->PSQT[fromPiece][from]
+                    - Tables->PSQT[enpassPiece][ep];
 
-    board->hash    ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[fromPiece][to]
-                   ^  ZobristKeys[enpassPiece][ep];
+    board->hash    ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[fromPiece][to]
+                   ^  Tables->ZobristKeys[enpassPiece][ep];
 
-    board->pkhash  ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[fromPiece][to]
-                   ^  ZobristKeys[enpassPiece][ep];
+    board->pkhash  ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[fromPiece][to]
+                   ^  Tables->ZobristKeys[enpassPiece][ep];
 
     assert(pieceType(fromPiece) == PAWN);
     assert(pieceType(enpassPiece) == PAWN);
@@ -265,19 +271,19 @@ void applyPromotionMove(Board *board, uint16_t move, Undo *undo) {
     board->squares[to]   = promoPiece;
     undo->capturePiece   = toPiece;
 
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
     board->castleRights &= CastleMask[to];
-    board->hash ^= ZobristCastleKeys[board->castleRights];
+    board->hash ^= Tables->ZobristCastleKeys[board->castleRights];
 
-    board->psqtmat += PSQT[promoPiece][to]
-                    - PSQT[fromPiece][from]
-                    - PSQT[toPiece][to];
+    board->psqtmat += Tables->PSQT[promoPiece][to]
+                    - Tables->PSQT[fromPiece][from]
+                    - Tables->PSQT[toPiece][to];
 
-    board->hash    ^= ZobristKeys[fromPiece][from]
-                   ^  ZobristKeys[promoPiece][to]
-                   ^  ZobristKeys[toPiece][to];
+    board->hash    ^= Tables->ZobristKeys[fromPiece][from]
+                   ^  Tables->ZobristKeys[promoPiece][to]
+                   ^  Tables->ZobristKeys[toPiece][to];
 
-    board->pkhash  ^= ZobristKeys[fromPiece][from];
+    board->pkhash  ^= Tables->ZobristKeys[fromPiece][from];
 
     assert(pieceType(fromPiece) == PAWN);
 }
@@ -291,16 +297,16 @@ void applyNullMove(Board *board, Undo *undo) {
     board->turn = !board->turn;
     board->history[board->numMoves++] = board->hash;
 
-    board->hash ^= ZobristTurnKey;
+    board->hash ^= Tables->ZobristTurnKey;
     if (board->epSquare != -1)
-        board->hash ^= ZobristEnpassKeys[fileOf(board->epSquare)];
+        board->hash ^= Tables->ZobristEnpassKeys[fileOf(board->epSquare)];
 
     board->epSquare = -1;
     board->fiftyMoveRule += 1;
 }
 
 void revert(Thread *thread, Board *board, uint16_t move, int height) {
-    Undo *undo = &thread->undoStack[height];
+    Undo *undo = &thread->stack[height].undo;
     if (move == NULL_MOVE) revertNullMove(board, undo);
     else revertMove(board, move, undo);
 }
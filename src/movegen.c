@@ -16,8 +16,9 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <stdint.h>
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "attacks.h"
 #include "board.h"
@@ -54,6 +55,39 @@ uint64_t pawnEnpassCaptures(uint64_t pawns, int epsq, int colour){
 }
 
 
+/* For Sharing Slider Attacks Within A Single Position */
+
+void clearAttackCache(AttackCache* cache){
+    cache->bishopValid = cache->rookValid = 0ull;
+}
+
+uint64_t cachedBishopAttacks(AttackCache* cache, int sq, uint64_t occupied){
+
+    if (cache == NULL)
+        return bishopAttacks(sq, occupied);
+
+    if (!testBit(cache->bishopValid, sq)){
+        cache->bishop[sq] = bishopAttacks(sq, occupied);
+        setBit(&cache->bishopValid, sq);
+    }
+
+    return cache->bishop[sq];
+}
+
+uint64_t cachedRookAttacks(AttackCache* cache, int sq, uint64_t occupied){
+
+    if (cache == NULL)
+        return rookAttacks(sq, occupied);
+
+    if (!testBit(cache->rookValid, sq)){
+        cache->rook[sq] = rookAttacks(sq, occupied);
+        setBit(&cache->rookValid, sq);
+    }
+
+    return cache->rook[sq];
+}
+
+
 /* For Building Actual Move Lists For Each Piece Type */
 
 void buildEnpassMoves(uint16_t* moves, int* size, uint64_t attacks, int epsq){
@@ -94,17 +128,17 @@ void buildKnightMoves(uint16_t* moves, int* size, uint64_t pieces, uint64_t targ
     }
 }
 
-void buildBishopAndQueenMoves(uint16_t* moves, int* size, uint64_t pieces, uint64_t occupied, uint64_t targets){
+void buildBishopAndQueenMoves(uint16_t* moves, int* size, uint64_t pieces, uint64_t occupied, uint64_t targets, AttackCache* cache){
     while (pieces){
         int sq = poplsb(&pieces);
-        buildNonPawnMoves(moves, size, bishopAttacks(sq, occupied) & targets, sq);
+        buildNonPawnMoves(moves, size, cachedBishopAttacks(cache, sq, occupied) & targets, sq);
     }
 }
 
-void buildRookAndQueenMoves(uint16_t* moves, int* size, uint64_t pieces, uint64_t occupied, uint64_t targets){
+void buildRookAndQueenMoves(uint16_t* moves, int* size, uint64_t pieces, uint64_t occupied, uint64_t targets, AttackCache* cache){
     while (pieces){
         int sq = poplsb(&pieces);
-        buildNonPawnMoves(moves, size, rookAttacks(sq, occupied) & targets, sq);
+        buildNonPawnMoves(moves, size, cachedRookAttacks(cache, sq, occupied) & targets, sq);
     }
 }
 
@@ -137,14 +171,14 @@ void genAllMoves(Board* board, uint16_t* moves, int* size){
 
     int noisy = 0, quiet = 0;
 
-    genAllNoisyMoves(board, moves, &noisy);
+    genAllNoisyMoves(board, moves, &noisy, NULL);
 
-    genAllQuietMoves(board, moves + noisy, &quiet);
+    genAllQuietMoves(board, moves + noisy, &quiet, NULL);
 
     *size = noisy + quiet;
 }
 
-void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
+void genAllNoisyMoves(Board* board, uint16_t* moves, int* size, AttackCache* cache){
 
     const int forwardShift = board->turn == WHITE ? -8 : 8;
     const int leftShift    = board->turn == WHITE ? -7 : 7;
@@ -212,12 +246,12 @@ void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
 
     // Generate attacks for all non pawn pieces
     buildKnightMoves(moves, size, myKnights, destinations);
-    buildBishopAndQueenMoves(moves, size, myBishops, occupied, destinations);
-    buildRookAndQueenMoves(moves, size, myRooks, occupied, destinations);
+    buildBishopAndQueenMoves(moves, size, myBishops, occupied, destinations, cache);
+    buildRookAndQueenMoves(moves, size, myRooks, occupied, destinations, cache);
     buildKingMoves(moves, size, myKings, enemy);
 }
 
-void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
+void genAllQuietMoves(Board* board, uint16_t* moves, int* size, AttackCache* cache){
 
     const uint64_t rank3Rel = board->turn == WHITE ? RANK_3 : RANK_6;
     const int forwardShift  = board->turn == WHITE ?     -8 :      8;
@@ -279,8 +313,8 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
 
     // Generate all moves for all non pawns aside from Castles
     buildKnightMoves(moves, size, myKnights, destinations);
-    buildBishopAndQueenMoves(moves, size, myBishops, occupied, destinations);
-    buildRookAndQueenMoves(moves, size, myRooks, occupied, destinations);
+    buildBishopAndQueenMoves(moves, size, myBishops, occupied, destinations, cache);
+    buildRookAndQueenMoves(moves, size, myRooks, occupied, destinations, cache);
     buildKingMoves(moves, size, myKings, empty);
 
     // Generate all the castling moves
@@ -311,6 +345,151 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
     }
 }
 
+void genAllQuietChecks(Board* board, uint16_t* moves, int* size, AttackCache* cache){
+
+    const uint64_t rank3Rel = board->turn == WHITE ? RANK_3 : RANK_6;
+    const int forwardShift  = board->turn == WHITE ?     -8 :      8;
+
+    int i, split;
+
+    uint64_t friendly = board->colours[board->turn];
+    uint64_t enemy    = board->colours[!board->turn];
+
+    uint64_t empty    = ~(friendly | enemy);
+    uint64_t occupied = ~empty;
+
+    int kingsq = getlsb(enemy & board->pieces[KING]);
+    uint64_t blockers = discoveredCheckBlockers(board);
+
+    uint64_t myPawns   = friendly & board->pieces[PAWN];
+    uint64_t myKnights = friendly & board->pieces[KNIGHT];
+    uint64_t myBishops = friendly & board->pieces[BISHOP];
+    uint64_t myRooks   = friendly & board->pieces[ROOK];
+    uint64_t myQueens  = friendly & board->pieces[QUEEN];
+    uint64_t myKings   = friendly & board->pieces[KING];
+
+    // Squares from which each piece type would attack the enemy king
+    uint64_t pawnChecks   = pawnAttacks(!board->turn, kingsq);
+    uint64_t knightChecks = knightAttacks(kingsq);
+    uint64_t bishopChecks = bishopAttacks(kingsq, occupied);
+    uint64_t rookChecks   = rookAttacks(kingsq, occupied);
+
+    uint64_t pawnForwardOne, pawnForwardTwo;
+
+    // Evasions must consider every move, which is left to the normal generators
+    if (board->kingAttackers) return;
+
+    // Direct checks, made by pieces which do not uncover an attack. A discovered
+    // check blocker is handled below, since any of its moves might give check
+    pawnForwardOne = pawnAdvance(myPawns & ~blockers, occupied, board->turn) & ~PROMOTION_RANKS;
+    pawnForwardTwo = pawnAdvance(pawnForwardOne & rank3Rel, occupied, board->turn);
+    buildPawnMoves(moves, size, pawnForwardOne & pawnChecks, forwardShift);
+    buildPawnMoves(moves, size, pawnForwardTwo & pawnChecks, forwardShift * 2);
+
+    buildKnightMoves(moves, size, myKnights & ~blockers, empty & knightChecks);
+    buildBishopAndQueenMoves(moves, size, myBishops & ~blockers, occupied, empty & bishopChecks, cache);
+    buildRookAndQueenMoves(moves, size, myRooks & ~blockers, occupied, empty & rookChecks, cache);
+    buildBishopAndQueenMoves(moves, size, myQueens & ~blockers, occupied, empty & (bishopChecks | rookChecks), cache);
+    buildRookAndQueenMoves(moves, size, myQueens & ~blockers, occupied, empty & (bishopChecks | rookChecks), cache);
+
+    // Discovered checks. Generate every quiet move of the blockers, and only keep
+    // those which leave the line to the king, or give a direct check anyway
+    if (!blockers) return;
+
+    split = *size;
+
+    pawnForwardOne = pawnAdvance(myPawns & blockers, occupied, board->turn) & ~PROMOTION_RANKS;
+    pawnForwardTwo = pawnAdvance(pawnForwardOne & rank3Rel, occupied, board->turn);
+    buildPawnMoves(moves, size, pawnForwardOne, forwardShift);
+    buildPawnMoves(moves, size, pawnForwardTwo, forwardShift * 2);
+
+    buildKnightMoves(moves, size, myKnights & blockers, empty);
+    buildBishopAndQueenMoves(moves, size, (myBishops | myQueens) & blockers, occupied, empty, cache);
+    buildRookAndQueenMoves(moves, size, (myRooks | myQueens) & blockers, occupied, empty, cache);
+    if (myKings & blockers) buildKingMoves(moves, size, myKings, empty);
+
+    for (i = split; i < *size; i++)
+        if (!moveGivesCheck(board, moves[i]))
+            moves[i--] = moves[--(*size)];
+}
+
+int moveGivesCheck(Board* board, uint16_t move){
+
+    const int from = MoveFrom(move), to = MoveTo(move);
+    const int ftype = pieceType(board->squares[from]);
+
+    int rFrom, rTo;
+
+    uint64_t friendly = board->colours[board->turn];
+    uint64_t enemy    = board->colours[!board->turn];
+    uint64_t occupied = friendly | enemy;
+
+    int kingsq = getlsb(enemy & board->pieces[KING]);
+
+    uint64_t pawns   = friendly &  board->pieces[PAWN];
+    uint64_t knights = friendly &  board->pieces[KNIGHT];
+    uint64_t bishops = friendly & (board->pieces[BISHOP] | board->pieces[QUEEN]);
+    uint64_t rooks   = friendly & (board->pieces[ROOK]   | board->pieces[QUEEN]);
+
+    // Lift the moving piece off of the board
+    occupied ^= 1ull << from;
+    pawns &= ~(1ull << from); knights &= ~(1ull << from);
+    bishops &= ~(1ull << from); rooks &= ~(1ull << from);
+
+    // Place the moving piece, or the promotion piece, on the destination
+    switch (MoveType(move) == PROMOTION_MOVE ? MovePromoPiece(move) : ftype){
+        case PAWN  : pawns   |= 1ull << to; break;
+        case KNIGHT: knights |= 1ull << to; break;
+        case BISHOP: bishops |= 1ull << to; break;
+        case ROOK  : rooks   |= 1ull << to; break;
+        case QUEEN : bishops |= 1ull << to; rooks |= 1ull << to; break;
+    }
+    occupied |= 1ull << to;
+
+    // Enpass removes the captured pawn, which may uncover an attack
+    if (MoveType(move) == ENPASS_MOVE)
+        occupied ^= 1ull << (to + (board->turn == WHITE ? -8 : 8));
+
+    // Castling moves the rook as well, which is the only piece that may check
+    if (MoveType(move) == CASTLE_MOVE){
+        rFrom = castleGetRookFrom(from, to);
+        rTo   = castleGetRookTo(from, to);
+        occupied = (occupied ^ (1ull << rFrom)) | (1ull << rTo);
+        rooks    = (rooks    ^ (1ull << rFrom)) | (1ull << rTo);
+    }
+
+    return !!(  (pawnAttacks(!board->turn, kingsq) & pawns)
+              | (knightAttacks(kingsq) & knights)
+              | (bishopAttacks(kingsq, occupied) & bishops)
+              | (rookAttacks(kingsq, occupied) & rooks));
+}
+
+uint64_t discoveredCheckBlockers(Board* board){
+
+    int sq;
+    uint64_t between, blockers = 0ull;
+
+    uint64_t friendly = board->colours[board->turn];
+    uint64_t enemy    = board->colours[!board->turn];
+    uint64_t occupied = friendly | enemy;
+
+    int kingsq = getlsb(enemy & board->pieces[KING]);
+
+    // Our sliders which would attack the enemy king on an empty board
+    uint64_t snipers = (friendly & (board->pieces[BISHOP] | board->pieces[QUEEN]) & bishopAttacks(kingsq, 0ull))
+                     | (friendly & (board->pieces[ROOK  ] | board->pieces[QUEEN]) & rookAttacks(kingsq, 0ull));
+
+    // A lone piece of ours between a sniper and the king is a blocker
+    while (snipers){
+        sq = poplsb(&snipers);
+        between = bitsBetweenMasks(kingsq, sq) & occupied;
+        if (onlyOne(between) && (between & friendly))
+            blockers |= between;
+    }
+
+    return blockers;
+}
+
 int isNotInCheck(Board* board, int colour){
     int kingsq = getlsb(board->colours[colour] & board->pieces[KING]);
     assert(board->squares[kingsq] == WHITE_KING + colour);
@@ -23,6 +23,11 @@
 
 #include "types.h"
 
+struct AttackCache {
+    uint64_t bishopValid, rookValid;
+    uint64_t bishop[SQUARE_NB], rook[SQUARE_NB];
+};
+
 uint64_t pawnLeftAttacks(uint64_t pawns, uint64_t targets, int colour);
 uint64_t pawnRightAttacks(uint64_t pawns, uint64_t targets, int colour);
 uint64_t pawnAttackSpan(uint64_t pawns, uint64_t targets, int colour);
@@ -31,8 +36,16 @@ uint64_t pawnEnpassCaptures(uint64_t pawns, int epsq, int colour);
 
 void genAllLegalMoves(Board* board, uint16_t* moves, int* size);
 void genAllMoves(Board* board, uint16_t* moves, int* size);
-void genAllNoisyMoves(Board* board, uint16_t* moves, int* size);
-void genAllQuietMoves(Board* board, uint16_t* moves, int* size);
+void genAllNoisyMoves(Board* board, uint16_t* moves, int* size, AttackCache* cache);
+void genAllQuietMoves(Board* board, uint16_t* moves, int* size, AttackCache* cache);
+void genAllQuietChecks(Board* board, uint16_t* moves, int* size, AttackCache* cache);
+
+void clearAttackCache(AttackCache* cache);
+uint64_t cachedBishopAttacks(AttackCache* cache, int sq, uint64_t occupied);
+uint64_t cachedRookAttacks(AttackCache* cache, int sq, uint64_t occupied);
+
+int moveGivesCheck(Board* board, uint16_t move);
+uint64_t discoveredCheckBlockers(Board* board);
 
 int isNotInCheck(Board* board, int colour);
 int squareIsAttacked(Board* board, int colour, int sq);
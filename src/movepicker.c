@@ -32,22 +32,23 @@
 #include "types.h"
 #include "thread.h"
 
-void initMovePicker(MovePicker* mp, Thread* thread, uint16_t ttMove, int height){
+void initMovePicker(MovePicker* mp, Thread* thread, AttackCache* cache, uint16_t ttMove, int height){
 
     // Start with the table move
     mp->stage = STAGE_TABLE;
 
     // Save possible special moves
     mp->tableMove = ttMove;
-    mp->killer1   = thread->killers[height][0];
-    mp->killer2   = thread->killers[height][1];
+    mp->killer1   = thread->stack[height].killers[0];
+    mp->killer2   = thread->stack[height].killers[1];
     mp->counter   = getCounterMove(thread, height);
 
     // Threshold for good noisy
     mp->threshold = 0;
 
-    // Reference to the board
+    // Reference to the board, and the attacks already computed for it
     mp->thread = thread;
+    mp->cache  = cache;
 
     // Reference for getting stats
     mp->height = height;
@@ -56,7 +57,7 @@ void initMovePicker(MovePicker* mp, Thread* thread, uint16_t ttMove, int height)
     mp->type = NORMAL_PICKER;
 }
 
-void initNoisyMovePicker(MovePicker* mp, Thread* thread, int threshold){
+void initNoisyMovePicker(MovePicker* mp, Thread* thread, AttackCache* cache, int threshold){
 
     // Start with just the noisy moves
     mp->stage = STAGE_GENERATE_NOISY;
@@ -70,8 +71,9 @@ void initNoisyMovePicker(MovePicker* mp, Thread* thread, int threshold){
     // Threshold for good noisy
     mp->threshold = threshold;
 
-    // Reference to the board
+    // Reference to the board, and the attacks already computed for it
     mp->thread = thread;
+    mp->cache  = cache;
 
     // No stats used, set to 0 to be safe
     mp->height = 0;
@@ -104,7 +106,7 @@ uint16_t selectNextMove(MovePicker* mp, Board* board, int skipQuiets){
         // fail a simple SEE, and try them after all quiet moves
 
         mp->noisySize = 0;
-        genAllNoisyMoves(board, mp->moves, &mp->noisySize);
+        genAllNoisyMoves(board, mp->moves, &mp->noisySize, mp->cache);
         evaluateNoisyMoves(mp);
         mp->split = mp->noisySize;
         mp->stage = STAGE_GOOD_NOISY;
@@ -201,7 +203,7 @@ uint16_t selectNextMove(MovePicker* mp, Board* board, int skipQuiets){
         // Generate and evaluate all quiet moves when not skipping quiet moves
         if (!skipQuiets){
             mp->quietSize = 0;
-            genAllQuietMoves(board, mp->moves + mp->split, &mp->quietSize);
+            genAllQuietMoves(board, mp->moves + mp->split, &mp->quietSize, mp->cache);
             evaluateQuietMoves(mp);
         }
 
@@ -328,7 +330,8 @@ void evaluateQuietMoves(MovePicker* mp){
     for (int i = mp->split; i < mp->split + mp->quietSize; i++)
         mp->values[i] = getHistoryScore(mp->thread, mp->moves[i])
                       + getCMHistoryScore(mp->thread, mp->height, mp->moves[i])
-                      + getFUHistoryScore(mp->thread, mp->height, mp->moves[i]);
+                      + getFUHistoryScore(mp->thread, mp->height, mp->moves[i])
+                      + getGainScore(mp->thread, mp->moves[i]) * GainOrderingWeight;
 }
 
 int moveIsPsuedoLegal(Board* board, uint16_t move){
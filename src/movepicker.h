@@ -41,15 +41,18 @@ struct MovePicker {
     int values[MAX_MOVES];
     uint16_t moves[MAX_MOVES];
     uint16_t tableMove, killer1, killer2, counter;
+    AttackCache *cache;
     Thread *thread;
 };
 
-void initMovePicker(MovePicker* mp, Thread* thread, uint16_t ttMove, int height);
-void initNoisyMovePicker(MovePicker* mp, Thread* thread, int threshold);
+void initMovePicker(MovePicker* mp, Thread* thread, AttackCache* cache, uint16_t ttMove, int height);
+void initNoisyMovePicker(MovePicker* mp, Thread* thread, AttackCache* cache, int threshold);
 uint16_t selectNextMove(MovePicker* mp, Board* board, int skipQuiets);
 int getBestMoveIndex(MovePicker *mp, int start, int end);
 void evaluateNoisyMoves(MovePicker* mp);
 void evaluateQuietMoves(MovePicker* mp);
 int moveIsPsuedoLegal(Board* board, uint16_t move);
 
+static const int GainOrderingWeight = 16;
+
 #endif
@@ -0,0 +1,178 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // For sched_setaffinity() and the CPU_SET() macros
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+#include "numa.h"
+#include "types.h"
+
+EngineTables MainTables; // Filled by the init functions of each module
+
+_Thread_local const EngineTables *Tables = &MainTables;
+
+int NUMA_REPLICATE; // Set by UCI options
+
+static EngineTables *Replicas[NUMA_MAX_NODES];
+static pthread_mutex_t REPLICALOCK = PTHREAD_MUTEX_INITIALIZER;
+
+#if defined(__linux__)
+
+static int NumaNodes; // Nodes with at least one CPU we may use
+static cpu_set_t NodeCPUs[NUMA_MAX_NODES];
+
+static _Thread_local int Bound; // Set while our affinity is replaced
+static _Thread_local cpu_set_t Unbound; // The affinity to restore after
+
+static int readNodeCPUs(int node, cpu_set_t *cpus) {
+
+    char path[128], line[4096], *ptr = line;
+    int first, last, length;
+    FILE *fin;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    if ((fin = fopen(path, "r")) == NULL) return 0;
+
+    CPU_ZERO(cpus);
+
+    // Formatted as comma separated ranges, such as "0-15,32-47"
+    if (fgets(line, sizeof(line), fin) != NULL) {
+        while (sscanf(ptr, "%d%n", &first, &length) == 1) {
+            last = first, ptr += length;
+            if (*ptr == '-' && sscanf(ptr + 1, "%d%n", &last, &length) == 1)
+                ptr += length + 1;
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+                CPU_SET(cpu, cpus);
+            if (*ptr++ != ',') break;
+        }
+    }
+
+    fclose(fin);
+    return 1;
+}
+
+void initNuma() {
+
+    cpu_set_t allowed, cpus;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return;
+
+    // Nodes may be numbered sparsely, and some may only hold memory
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        if (!readNodeCPUs(node, &cpus)) continue;
+        CPU_AND(&cpus, &cpus, &allowed);
+        if (CPU_COUNT(&cpus)) NodeCPUs[NumaNodes++] = cpus;
+    }
+}
+
+static int bindToNode(int index) {
+
+    // Threads are spread evenly, and are kept on their node so that
+    // the copy of the tables they are using stays local to them
+    int node = index % NumaNodes;
+
+    // Remember the affinity we had, so that it may be restored after
+    if (!Bound && sched_getaffinity(0, sizeof(cpu_set_t), &Unbound) == 0)
+        Bound = sched_setaffinity(0, sizeof(cpu_set_t), &NodeCPUs[node]) == 0;
+
+    return node;
+}
+
+static void unbindFromNode() {
+    if (Bound) sched_setaffinity(0, sizeof(cpu_set_t), &Unbound), Bound = 0;
+}
+
+#else
+
+static int NumaNodes; // Replication is only supported on Linux for now
+
+void initNuma() {}
+
+static int bindToNode(int index) {
+    (void) index; return 0;
+}
+
+static void unbindFromNode() {}
+
+#endif
+
+static EngineTables* copyTables() {
+
+    EngineTables *copy = malloc(sizeof(EngineTables));
+
+    // The copy is first written by a thread running on the target node,
+    // so that the usual first touch policy places its pages on that node
+    memcpy(copy, &MainTables, sizeof(EngineTables));
+
+    // Magic lookups hold pointers into the attack tables
+    for (int sq = 0; sq < SQUARE_NB; sq++) {
+        copy->BishopTable[sq].offset = copy->BishopAttacks
+            + (MainTables.BishopTable[sq].offset - MainTables.BishopAttacks);
+        copy->RookTable[sq].offset = copy->RookAttacks
+            + (MainTables.RookTable[sq].offset - MainTables.RookAttacks);
+    }
+
+    return copy;
+}
+
+void useNumaTables(int index) {
+
+    int node;
+
+    Tables = &MainTables;
+
+    if (!NUMA_REPLICATE || NumaNodes <= 1)
+        return;
+
+    node = bindToNode(index);
+
+    // The first thread to arrive on each node builds its copy
+    pthread_mutex_lock(&REPLICALOCK);
+    if (Replicas[node] == NULL)
+        Replicas[node] = copyTables();
+    pthread_mutex_unlock(&REPLICALOCK);
+
+    Tables = Replicas[node];
+}
+
+void releaseNumaTables() {
+
+    // The calling thread may go on to run other code, which should
+    // not be left bound to the node used for the search
+    unbindFromNode();
+    Tables = &MainTables;
+}
+
+void resetNumaTables() {
+
+    // Must not be called during a search. Copies are rebuilt when needed
+    for (int node = 0; node < NUMA_MAX_NODES; node++)
+        free(Replicas[node]), Replicas[node] = NULL;
+}
@@ -0,0 +1,75 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "attacks.h"
+#include "types.h"
+
+enum { NUMA_MAX_NODES = 64 };
+
+// Tables which are written once during initialization, or when loading new
+// weights, and then only read by the search. Each Numa node may have its own
+// copy, with every thread reading through Tables, pointing to the local copy
+
+struct EngineTables {
+
+    // Attack tables, see attacks.c
+    uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
+    uint64_t KnightAttacks[SQUARE_NB];
+    uint64_t KingAttacks[SQUARE_NB];
+    Magic BishopTable[SQUARE_NB];
+    Magic RookTable[SQUARE_NB];
+    uint64_t BishopAttacks[0x1480];
+    uint64_t RookAttacks[0x19000];
+
+    // Masks, see masks.c
+    int DistanceBetween[SQUARE_NB][SQUARE_NB];
+    uint64_t BitsBetweenMasks[SQUARE_NB][SQUARE_NB];
+    uint64_t KingAreaMasks[COLOUR_NB][SQUARE_NB];
+    uint64_t ForwardRanksMasks[COLOUR_NB][RANK_NB];
+    uint64_t AdjacentFilesMasks[FILE_NB];
+    uint64_t PassedPawnMasks[COLOUR_NB][SQUARE_NB];
+    uint64_t PawnConnectedMasks[COLOUR_NB][SQUARE_NB];
+    uint64_t OutpostSquareMasks[COLOUR_NB][SQUARE_NB];
+    uint64_t OutpostRanksMasks[COLOUR_NB];
+
+    // Hashing keys, see zobrist.c
+    uint64_t ZobristKeys[32][SQUARE_NB];
+    uint64_t ZobristEnpassKeys[FILE_NB];
+    uint64_t ZobristCastleKeys[0x10];
+    uint64_t ZobristTurnKey;
+
+    // Piece square tables, see psqt.c
+    int PSQT[32][SQUARE_NB];
+
+    // Late Move Reductions, LMRTable[depth][played], see search.c
+    int LMRTable[64][64];
+};
+
+extern EngineTables MainTables;
+extern _Thread_local const EngineTables *Tables;
+
+extern int NUMA_REPLICATE;
+
+void initNuma();
+void useNumaTables(int index);
+void releaseNumaTables();
+void resetNumaTables();
@@ -19,14 +19,13 @@
 #include "assert.h"
 #include "bitboards.h"
 #include "evaluate.h"
+#include "numa.h"
 #include "psqt.h"
 #include "types.h"
 
-int PSQT[32][SQUARE_NB];
-
 #define S(mg, eg) MakeScore((mg), (eg))
 
-const int PawnPSQT32[32] = {
+int PawnPSQT32[32] = {
     S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
     S( -20,  10), S(   5,   2), S( -15,   7), S(  -9,  -3),
     S( -20,   3), S( -13,   2), S(  -9,  -7), S(  -5, -15),
@@ -37,7 +36,7 @@ const int PawnPSQT32[32] = {
     S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
 };
 
-const int KnightPSQT32[32] = {
+int KnightPSQT32[32] = {
     S( -49, -26), S(  -8, -46), S( -18, -31), S(  -2, -21),
     S(  -7, -21), S(   3, -14), S(  -1, -31), S(  10, -20),
     S(   1, -25), S(  21, -24), S(  13, -18), S(  24,  -1),
@@ -48,7 +47,7 @@ const int KnightPSQT32[32] = {
     S(-163, -16), S( -83,  -3), S(-114,  17), S( -33,   0),
 };
 
-const int BishopPSQT32[32] = {
+int BishopPSQT32[32] = {
     S(  17, -17), S(  16, -20), S( -11,  -8), S(   8, -13),
     S(  34, -31), S(  26, -32), S(  24, -21), S(  10, -11),
     S(  17, -13), S(  31, -14), S(  17,  -4), S(  19,  -2),
@@ -59,7 +58,7 @@ const int BishopPSQT32[32] = {
     S( -42,   0), S( -50,   5), S( -92,  13), S( -96,  21),
 };
 
-const int RookPSQT32[32] = {
+int RookPSQT32[32] = {
     S(  -6, -30), S( -12, -20), S(   0, -25), S(   8, -30),
     S( -54, -14), S( -15, -30), S(  -9, -31), S(  -2, -33),
     S( -27, -14), S(  -7, -12), S( -17, -15), S(  -4, -24),
@@ -70,7 +69,7 @@ const int RookPSQT32[32] = {
     S(  37,  20), S(  26,  23), S(   3,  28), S(  14,  24),
 };
 
-const int QueenPSQT32[32] = {
+int QueenPSQT32[32] = {
     S(   8, -53), S(  -8, -38), S(   0, -51), S(  15, -45),
     S(   9, -39), S(  23, -57), S(  26, -73), S(  16, -25),
     S(   8, -20), S(  24, -18), S(   6,   4), S(   6,   2),
@@ -81,7 +80,7 @@ const int QueenPSQT32[32] = {
     S( -15,   9), S(  12,   0), S(   5,   1), S( -11,  14),
 };
 
-const int KingPSQT32[32] = {
+int KingPSQT32[32] = {
     S(  41, -82), S(  42, -52), S(  -9, -14), S( -26, -22),
     S(  32, -35), S(   0, -25), S( -34,   2), S( -48,   4),
     S(  13, -36), S(  24, -33), S(  21,  -8), S(  -3,   6),
@@ -107,18 +106,18 @@ void initializePSQT() {
         const int w32 = relativeSquare32(s, WHITE);
         const int b32 = relativeSquare32(s, BLACK);
 
-        PSQT[WHITE_PAWN  ][s] = +MakeScore(PieceValues[PAWN  ][MG], PieceValues[PAWN  ][EG]) +   PawnPSQT32[w32];
-        PSQT[WHITE_KNIGHT][s] = +MakeScore(PieceValues[KNIGHT][MG], PieceValues[KNIGHT][EG]) + KnightPSQT32[w32];
-        PSQT[WHITE_BISHOP][s] = +MakeScore(PieceValues[BISHOP][MG], PieceValues[BISHOP][EG]) + BishopPSQT32[w32];
-        PSQT[WHITE_ROOK  ][s] = +MakeScore(PieceValues[ROOK  ][MG], PieceValues[ROOK  ][EG]) +   RookPSQT32[w32];
-        PSQT[WHITE_QUEEN ][s] = +MakeScore(PieceValues[QUEEN ][MG], PieceValues[QUEEN ][EG]) +  QueenPSQT32[w32];
-        PSQT[WHITE_KING  ][s] = +MakeScore(PieceValues[KING  ][MG], PieceValues[KING  ][EG]) +   KingPSQT32[w32];
-
-        PSQT[BLACK_PAWN  ][s] = -MakeScore(PieceValues[PAWN  ][MG], PieceValues[PAWN  ][EG]) -   PawnPSQT32[b32];
-        PSQT[BLACK_KNIGHT][s] = -MakeScore(PieceValues[KNIGHT][MG], PieceValues[KNIGHT][EG]) - KnightPSQT32[b32];
-        PSQT[BLACK_BISHOP][s] = -MakeScore(PieceValues[BISHOP][MG], PieceValues[BISHOP][EG]) - BishopPSQT32[b32];
-        PSQT[BLACK_ROOK  ][s] = -MakeScore(PieceValues[ROOK  ][MG], PieceValues[ROOK  ][EG]) -   RookPSQT32[b32];
-        PSQT[BLACK_QUEEN ][s] = -MakeScore(PieceValues[QUEEN ][MG], PieceValues[QUEEN ][EG]) -  QueenPSQT32[b32];
-        PSQT[BLACK_KING  ][s] = -MakeScore(PieceValues[KING  ][MG], PieceValues[KING  ][EG]) -   KingPSQT32[b32];
+        MainTables.PSQT[WHITE_PAWN  ][s] = +MakeScore(PieceValues[PAWN  ][MG], PieceValues[PAWN  ][EG]) +   PawnPSQT32[w32];
+        MainTables.PSQT[WHITE_KNIGHT][s] = +MakeScore(PieceValues[KNIGHT][MG], PieceValues[KNIGHT][EG]) + KnightPSQT32[w32];
+        MainTables.PSQT[WHITE_BISHOP][s] = +MakeScore(PieceValues[BISHOP][MG], PieceValues[BISHOP][EG]) + BishopPSQT32[w32];
+        MainTables.PSQT[WHITE_ROOK  ][s] = +MakeScore(PieceValues[ROOK  ][MG], PieceValues[ROOK  ][EG]) +   RookPSQT32[w32];
+        MainTables.PSQT[WHITE_QUEEN ][s] = +MakeScore(PieceValues[QUEEN ][MG], PieceValues[QUEEN ][EG]) +  QueenPSQT32[w32];
+        MainTables.PSQT[WHITE_KING  ][s] = +MakeScore(PieceValues[KING  ][MG], PieceValues[KING  ][EG]) +   KingPSQT32[w32];
+
+        MainTables.PSQT[BLACK_PAWN  ][s] = -MakeScore(PieceValues[PAWN  ][MG], PieceValues[PAWN  ][EG]) -   PawnPSQT32[b32];
+        MainTables.PSQT[BLACK_KNIGHT][s] = -MakeScore(PieceValues[KNIGHT][MG], PieceValues[KNIGHT][EG]) - KnightPSQT32[b32];
+        MainTables.PSQT[BLACK_BISHOP][s] = -MakeScore(PieceValues[BISHOP][MG], PieceValues[BISHOP][EG]) - BishopPSQT32[b32];
+        MainTables.PSQT[BLACK_ROOK  ][s] = -MakeScore(PieceValues[ROOK  ][MG], PieceValues[ROOK  ][EG]) -   RookPSQT32[b32];
+        MainTables.PSQT[BLACK_QUEEN ][s] = -MakeScore(PieceValues[QUEEN ][MG], PieceValues[QUEEN ][EG]) -  QueenPSQT32[b32];
+        MainTables.PSQT[BLACK_KING  ][s] = -MakeScore(PieceValues[KING  ][MG], PieceValues[KING  ][EG]) -   KingPSQT32[b32];
     }
 }
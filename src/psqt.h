@@ -21,5 +21,3 @@
 void initializePSQT();
 
 int relativeSquare32(int s, int c);
-
-extern int PSQT[32][SQUARE_NB];
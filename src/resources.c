@@ -0,0 +1,158 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // For sched_getaffinity() and CPU_COUNT()
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+#include "resources.h"
+#include "thread.h"
+#include "types.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+static int readFirstLine(const char *path, char *line, int size) {
+
+    FILE *fin = fopen(path, "r");
+    int success = fin != NULL && fgets(line, size, fin) != NULL;
+
+    if (fin != NULL) fclose(fin);
+    return success;
+}
+
+static int readCgroupFile(const char *controller, const char *file, char *line, int size) {
+
+    char path[512], entry[512], *ptr;
+    FILE *fin;
+
+    // cgroup v2 has a single hierarchy, listed as "0::/path" in /proc/self/cgroup.
+    // Inside of a container namespace the path is usually just "/"
+    if ((fin = fopen("/proc/self/cgroup", "r")) != NULL) {
+        while (fgets(entry, sizeof(entry), fin) != NULL) {
+            if (strncmp(entry, "0::", 3)) continue;
+            if ((ptr = strchr(entry, '\n')) != NULL) *ptr = '\0';
+            snprintf(path, sizeof(path), "/sys/fs/cgroup%s/%s", entry + 3, file);
+            if (readFirstLine(path, line, size)) { fclose(fin); return 1; }
+        }
+        fclose(fin);
+    }
+
+    // cgroup v2 mounted at the root of the container
+    snprintf(path, sizeof(path), "/sys/fs/cgroup/%s", file);
+    if (readFirstLine(path, line, size)) return 1;
+
+    // cgroup v1 uses one hierarchy per controller
+    snprintf(path, sizeof(path), "/sys/fs/cgroup/%s/%s", controller, file);
+    return readFirstLine(path, line, size);
+}
+
+#endif
+
+int availableCPUs() {
+
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return MAX(1, (int)sysinfo.dwNumberOfProcessors);
+#else
+    char line[256];
+    long long quota, period;
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    // Limit to the set of CPUs we are allowed to be scheduled on
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        cpus = CPU_COUNT(&mask);
+
+    // cgroup v2 CPU quota, formatted as "$MAX $PERIOD" or "max $PERIOD"
+    if (    readCgroupFile("cpu", "cpu.max", line, sizeof(line))
+        &&  sscanf(line, "%lld %lld", &quota, &period) == 2 && period > 0)
+        cpus = MIN(cpus, (int)((quota + period - 1) / period));
+
+    // cgroup v1 CPU quota, where a quota of -1 means no limit at all
+    else if (   readCgroupFile("cpu", "cpu.cfs_quota_us", line, sizeof(line))
+             && (quota = atoll(line)) > 0
+             && readCgroupFile("cpu", "cpu.cfs_period_us", line, sizeof(line))
+             && (period = atoll(line)) > 0)
+        cpus = MIN(cpus, (int)((quota + period - 1) / period));
+
+    return MAX(1, cpus);
+#endif
+}
+
+uint64_t availableMemory() {
+
+#if defined(_WIN32) || defined(_WIN64)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    GlobalMemoryStatusEx(&status);
+    return (uint64_t)status.ullTotalPhys;
+#else
+    char line[256];
+    uint64_t limit;
+    uint64_t memory = (uint64_t)sysconf(_SC_PHYS_PAGES) * (uint64_t)sysconf(_SC_PAGESIZE);
+
+    // cgroup v2 memory limit, which is the string "max" when unlimited
+    if (   readCgroupFile("memory", "memory.max", line, sizeof(line))
+        && (limit = strtoull(line, NULL, 10)) > 0)
+        memory = MIN(memory, limit);
+
+    // cgroup v1 memory limit, which is a very large number when unlimited
+    else if (   readCgroupFile("memory", "memory.limit_in_bytes", line, sizeof(line))
+             && (limit = strtoull(line, NULL, 10)) > 0)
+        memory = MIN(memory, limit);
+
+    return memory;
+#endif
+}
+
+int autoThreadCount() {
+    return MIN(MAX_THREADS, availableCPUs());
+}
+
+int autoHashMegabytes(int nthreads) {
+
+    uint64_t memory   = availableMemory();
+    uint64_t reserved = AUTO_RESERVED_MB << 20;
+    uint64_t perThread = sizeof(Thread) + (AUTO_STACK_MB << 20);
+    uint64_t megabytes = 1;
+
+    // Leave room for the process itself, and for each Thread's tables
+    if (memory <= reserved + nthreads * perThread)
+        return 1;
+
+    memory = (memory - reserved - nthreads * perThread) >> 20;
+
+    // initTT() will use a power of two at or below the requested size
+    while (megabytes * 2 <= memory && megabytes * 2 <= MAX_HASH_MB)
+        megabytes *= 2;
+
+    return (int)megabytes;
+}
@@ -0,0 +1,36 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    MAX_THREADS      =  2048, // Matches the UCI option limit
+    MAX_HASH_MB      = 65536, // Matches the UCI option limit
+    AUTO_RESERVED_MB =    64, // Left aside for the process itself
+    AUTO_STACK_MB    =     1, // Search stack estimate for each Thread
+};
+
+int availableCPUs();
+uint64_t availableMemory();
+
+int autoThreadCount();
+int autoHashMegabytes(int nthreads);
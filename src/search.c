@@ -31,13 +31,19 @@
 #include "board.h"
 #include "castle.h"
 #include "evaluate.h"
+#include "experience.h"
 #include "fathom/tbprobe.h"
+#include "governor.h"
 #include "history.h"
+#include "interleave.h"
+#include "monitor.h"
 #include "move.h"
 #include "movegen.h"
 #include "movepicker.h"
+#include "numa.h"
 #include "psqt.h"
 #include "search.h"
+#include "suspend.h"
 #include "syzygy.h"
 #include "thread.h"
 #include "time.h"
@@ -47,24 +53,26 @@
 #include "windows.h"
 
 
-int LMRTable[64][64]; // Late Move Reductions, LMRTable[depth][played]
-
 volatile int ABORT_SIGNAL; // Global ABORT flag for threads
 
 volatile int IS_PONDERING; // Global PONDER flag for threads
 
+volatile int IS_WARMING; // Global flag for background TT warming
+
 
 void initSearch(){
 
     // Init Late Move Reductions Table
     for (int d = 1; d < 64; d++)
         for (int p = 1; p < 64; p++)
-            LMRTable[d][p] = 0.75 + log(d) * log(p) / 2.25;
+            MainTables.LMRTable[d][p] = 0.75 + log(d) * log(p) / 2.25;
 }
 
 void getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t *best, uint16_t *ponder){
 
-    ABORT_SIGNAL = 0; // Clear the ABORT signal for the new search
+    // Clear the ABORT signal for the new search. A warming search is armed
+    // by the UCI thread, which may already have asked for it to be cancelled
+    if (!IS_WARMING) ABORT_SIGNAL = 0;
 
     updateTT(); // Table is on a new search, thus a new generation
 
@@ -78,9 +86,22 @@ void getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t *best,
     memset(&info, 0, sizeof(SearchInfo));
     initTimeManagment(&info, limits);
 
+    // Continue from the last completed depth of a resumed search
+    resumeSearchInfo(&info);
+
     // Setup the thread pool for a new search
     newSearchThreadPool(threads, board, limits, &info);
 
+    // Reset the controller for the Syzygy probe depth
+    tablebasesNewSearch();
+
+    // Split the CPU budget between the threads
+    governorNewSearch(threads);
+
+    // Start sampling the threads, if the monitor is enabled
+    Monitor monitor;
+    startMonitor(&monitor, threads);
+
     // Launch all of the threads
     pthread_t pthreads[threads[0].nthreads];
     for (int i = 1; i < threads[0].nthreads; i++)
@@ -91,11 +112,37 @@ void getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t *best,
     for (int i = 1; i < threads[0].nthreads; i++)
         pthread_join(pthreads[i], NULL);
 
+    // Stop the monitor before the final report and bestmove
+    stopMonitor(&monitor);
+
+    // Save the state of the search, if asked to suspend it
+    if (!IS_WARMING) suspendIfRequested(threads, board, &info);
+
     // Save the best move and ponder move
     *best = info.bestMoves[info.depth];
     *ponder = info.ponderMoves[info.depth];
 }
 
+void warmSearch(Thread* threads, Board* board, uint16_t best, uint16_t ponder){
+
+    Board copy;
+    Limits limits;
+    Undo undo[2];
+    uint16_t warmBest, warmPonder;
+
+    // Search the position we expect to face after our move and the reply
+    memcpy(&copy, board, sizeof(Board));
+    applyMove(&copy, best, &undo[0]);
+    applyMove(&copy, ponder, &undo[1]);
+
+    // Search until cancelled by the next UCI command
+    memset(&limits, 0, sizeof(Limits));
+    limits.start = getRealTime();
+    limits.limitedByNone = 1;
+
+    getBestMove(threads, &copy, &limits, &warmBest, &warmPonder);
+}
+
 void* iterativeDeepening(void* vthread){
 
     Thread* const thread   = (Thread*) vthread;
@@ -108,8 +155,15 @@ void* iterativeDeepening(void* vthread){
     if (thread->nthreads > 8)
         bindThisThread(thread->index);
 
-    // Perform iterative deepening until exit conditions
-    for (thread->depth = 1; thread->depth < MAX_PLY; thread->depth++){
+    // Read from the copy of the tables local to our Numa node, if enabled
+    useNumaTables(thread->index);
+
+    // Apply the priority requested for the CPU governor
+    governorStartThread(thread);
+
+    // Perform iterative deepening until exit conditions, starting after
+    // the last completed depth, in case we have resumed a suspended search
+    for (thread->depth += 1; thread->depth < MAX_PLY; thread->depth++){
 
         // If we abort to here, we stop searching
         if (setjmp(thread->jbuffer)) break;
@@ -133,6 +187,12 @@ void* iterativeDeepening(void* vthread){
         // Send information about this search to the interface
         uciReport(thread->threads, -MATE, MATE, thread->value);
 
+        // Queue deep results to be saved in the experience file
+        recordExperience(&thread->board, thread->pv.line[0], thread->value, thread->depth);
+
+        // Adjust the Syzygy probe depth based on the observed latency
+        tablebasesUpdateProbeDepth(thread->threads);
+
         // Update time allocation based on score and pv changes
         updateTimeManagment(info, limits, thread->depth, thread->value);
 
@@ -150,6 +210,9 @@ void* iterativeDeepening(void* vthread){
     // Main thread should kill others when finishing
     if (mainThread) ABORT_SIGNAL = 1;
 
+    // Undo any binding made for our Numa node
+    releaseNumaTables();
+
     return NULL;
 }
 
@@ -196,22 +259,27 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     Board* const board = &thread->board;
 
     unsigned tbresult;
-    int quiets = 0, played = 0, hist = 0, cmhist = 0, fuhist = 0;
+    int quiets = 0, played = 0, hist = 0, cmhist = 0, fuhist = 0, gain;
     int ttHit, ttValue = 0, ttEval = 0, ttDepth = 0, ttBound = 0;
     int i, R, newDepth, rAlpha, rBeta, oldAlpha = alpha;
     int inCheck, isQuiet, improving, extension, skipQuiets = 0;
     int eval, value = -MATE, best = -MATE, futilityMargin, seeMargin[2];
     uint16_t move, ttMove = NONE_MOVE, bestMove = NONE_MOVE, quietsTried[MAX_MOVES];
     MovePicker movePicker;
+    AttackCache cache;
 
     PVariation lpv;
     lpv.length = 0;
     pv->length = 0;
 
+    // Slider attacks computed by the evaluation and by the move generation
+    // are shared between them, but only for this position
+    clearAttackCache(&cache);
+
     // Step 1. Quiescence Search. Perform a search using mostly tactical
     // moves to reach a more stable position for use as a static evaluation
     if (depth <= 0 && !board->kingAttackers)
-        return qsearch(thread, pv, alpha, beta, height);
+        return qsearch(thread, pv, alpha, beta, 0, height);
 
     // Ensure positive depth
     depth = MAX(0, depth);
@@ -236,7 +304,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
 
         // Check to see if we have exceeded the maxiumum search draft
         if (height >= MAX_PLY)
-            return evaluateBoard(board, &thread->pktable);
+            return evaluateBoard(board, &thread->pktable, &cache);
 
         // Mate Distance Pruning. Check to see if this line is so
         // good, or so bad, that being mated in the ply, or  mating in
@@ -246,6 +314,12 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         if (rAlpha >= rBeta) return rAlpha;
     }
 
+#ifdef INTERLEAVE
+    // Let an interleaved search run while the Table entry is fetched
+    if (thread->fiber != NULL)
+        yieldSearchFiber(thread->fiber, board->hash);
+#endif
+
     // Step 4. Probe the Transposition Table, adjust the value, and consider cutoffs
     if ((ttHit = getTTEntry(board->hash, &ttMove, &ttValue, &ttEval, &ttDepth, &ttBound))){
 
@@ -263,10 +337,13 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         }
     }
 
+    // Track the Table hit rate for the Thread health monitor
+    thread->ttprobes += 1; thread->tthits += ttHit;
+
     // Step 5. Probe the Syzygy Tablebases. tablebasesProbeWDL() handles all of
     // the conditions about the board, the existance of tables, the probe depth,
     // as well as to not probe at the Root. The return is defined by the Fathom API
-    if ((tbresult = tablebasesProbeWDL(board, depth, height)) != TB_RESULT_FAILED){
+    if ((tbresult = tablebasesProbeWDL(thread, depth, height)) != TB_RESULT_FAILED){
 
         thread->tbhits++; // Increment tbhits counter for this thread
 
@@ -297,8 +374,11 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     inCheck = !!board->kingAttackers;
 
     // Save off static evaluation history. Reuse TT entry eval if possible
-    eval = thread->evalStack[height] = ttHit && ttEval != VALUE_NONE ? ttEval
-                                     : evaluateBoard(board, &thread->pktable);
+    eval = thread->stack[height].eval = ttHit && ttEval != VALUE_NONE ? ttEval
+                                      : evaluateBoard(board, &thread->pktable, &cache);
+
+    // Learn the eval gain of the quiet move which led to this position
+    if (height >= 1) updateGainHistory(thread, height, eval);
 
     // Futility Pruning Margin
     futilityMargin = eval + FutilityMargin * depth;
@@ -308,11 +388,11 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     seeMargin[1] = SEEQuietMargin * depth;
 
     // Improving if our static eval increased in the last move
-    improving = height >= 2 && eval > thread->evalStack[height-2];
+    improving = height >= 2 && eval > thread->stack[height-2].eval;
 
     // Reset Killer moves for our children
-    thread->killers[height+1][0] = NONE_MOVE;
-    thread->killers[height+1][1] = NONE_MOVE;
+    thread->stack[height+1].killers[0] = NONE_MOVE;
+    thread->stack[height+1].killers[1] = NONE_MOVE;
 
     // Step 7. Razoring. If a Quiescence Search for the current position
     // still falls way below alpha, we will assume that the score from
@@ -321,7 +401,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         && !inCheck
         &&  depth <= RazorDepth
         &&  eval + RazorMargin < alpha)
-        return qsearch(thread, pv, alpha, beta, height);
+        return qsearch(thread, pv, alpha, beta, 0, height);
 
     // Step 8. Beta Pruning / Reverse Futility Pruning / Static Null
     // Move Pruning. If the eval is few pawns above beta then exit early
@@ -341,8 +421,8 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         &&  depth >= NullMovePruningDepth
         &&  eval >= beta
         &&  hasNonPawnMaterial(board, board->turn)
-        &&  thread->moveStack[height-1] != NULL_MOVE
-        &&  thread->moveStack[height-2] != NULL_MOVE
+        &&  thread->stack[height-1].move != NULL_MOVE
+        &&  thread->stack[height-2].move != NULL_MOVE
         && (!ttHit || !(ttBound & BOUND_UPPER) || ttValue >= beta)) {
 
         R = 4 + depth / 6 + MIN(3, (eval - beta) / 200);
@@ -365,7 +445,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
 
         rBeta = MIN(beta + ProbCutMargin, MATE - MAX_PLY - 1);
 
-        initMovePicker(&movePicker, thread, NONE_MOVE, height);
+        initMovePicker(&movePicker, thread, &cache, NONE_MOVE, height);
 
         while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE){
 
@@ -394,7 +474,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
 
     // Step 11. Initialize the Move Picker and being searching through each
     // move one at a time, until we run out or a move generates a cutoff
-    initMovePicker(&movePicker, thread, ttMove, height);
+    initMovePicker(&movePicker, thread, &cache, ttMove, height);
     while ((move = selectNextMove(&movePicker, board, skipQuiets)) != NONE_MOVE){
 
         // If this move is quiet we will save it to a list of attemped quiets.
@@ -407,34 +487,44 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         }
 
         // Step 12. Quiet Move Pruning. Prune any quiet move that meets one
-        // of the criteria below, except for mated lines and Root node moves
+        // of the criteria below, except for mated lines, Root node moves,
+        // and moves which give check. Checks are detected without applying
+        // the moves, but only for those moves which would otherwise be pruned
         if (!RootNode && isQuiet && best > MATED_IN_MAX) {
 
             // Step 12A. Futility Pruning. If our score is far below alpha, and we
             // don't expect anything from this move, we can skip all other quiets
-            if (   futilityMargin <= alpha
-                && depth <= FutilityPruningDepth
-                && hist < FutilityPruningHistoryLimit[improving])
-                skipQuiets = 1;
-
-            // Step 12B. Late Move Pruning / Move Count Pruning. If we have
+            int skipAll = futilityMargin <= alpha
+                       && depth <= FutilityPruningDepth
+                       && hist < FutilityPruningHistoryLimit[improving];
+
+            // Step 12B. Gain Futility Pruning. Skip just this move if it has
+            // only ever lost eval, by enough to fall short of the 12A margin
+            int skipThis = depth <= FutilityPruningDepth
+                        && (gain = getGainScore(thread, move)) < 0
+                        && futilityMargin + gain <= alpha
+                        && hist < FutilityPruningHistoryLimit[improving];
+
+            // Step 12C. Late Move Pruning / Move Count Pruning. If we have
             // tried many quiets in this position already, and we don't expect
             // anything from this move, we can skip all the remaining quiets
-            if (   depth <= LateMovePruningDepth
-                && quiets >= LateMovePruningCounts[improving][depth])
-                skipQuiets = 1;
+            skipAll |= depth <= LateMovePruningDepth
+                    && quiets >= LateMovePruningCounts[improving][depth];
 
-            // Step 12C. Counter Move Pruning. Moves with poor counter
+            // Step 12D. Counter Move Pruning. Moves with poor counter
             // move history are pruned at near leaf nodes of the search.
-            if (   depth <= CounterMovePruningDepth[improving]
-                && cmhist < CounterMoveHistoryLimit[improving])
-                continue;
+            skipThis |= depth <= CounterMovePruningDepth[improving]
+                     && cmhist < CounterMoveHistoryLimit[improving];
 
-            // Step 12D. Follow Up Move Pruning. Moves with poor follow up
+            // Step 12E. Follow Up Move Pruning. Moves with poor follow up
             // move history are pruned at near leaf nodes of the search.
-            if (   depth <= FollowUpMovePruningDepth[improving]
-                && fuhist < FollowUpMoveHistoryLimit[improving])
-                continue;
+            skipThis |= depth <= FollowUpMovePruningDepth[improving]
+                     && fuhist < FollowUpMoveHistoryLimit[improving];
+
+            if ((skipAll || skipThis) && !moveGivesCheck(board, move)) {
+                skipQuiets |= skipAll;
+                if (skipThis) continue;
+            }
         }
 
         // Step 13. Static Exchange Evaluation Pruning. Prune moves which fail
@@ -458,7 +548,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         // allow the later steps to perform the reduced searches
         if (isQuiet && depth > 2 && played > 1){
 
-            R  = LMRTable[MIN(depth, 63)][MIN(played, 63)];
+            R  = Tables->LMRTable[MIN(depth, 63)][MIN(played, 63)];
 
             // Increase for non PV nodes
             R += !PvNode;
@@ -549,9 +639,9 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         // Search failed high. Update move tables and break.
         if (alpha >= beta){
 
-            if (isQuiet && thread->killers[height][0] != move){
-                thread->killers[height][1] = thread->killers[height][0];
-                thread->killers[height][0] = move;
+            if (isQuiet && thread->stack[height].killers[0] != move){
+                thread->stack[height].killers[1] = thread->stack[height].killers[0];
+                thread->stack[height].killers[0] = move;
             }
 
             if (isQuiet)
@@ -590,20 +680,23 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     return best;
 }
 
-int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
+int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int height){
 
     Board* const board = &thread->board;
 
-    int eval, value, best, margin;
+    int i = 0, size = -1, eval, value, best, margin = 0, evading;
     int ttHit, ttValue = 0, ttEval = 0, ttDepth = 0, ttBound = 0;
-    uint16_t move, ttMove = NONE_MOVE;
+    uint16_t move, ttMove = NONE_MOVE, checks[MAX_MOVES];
 
     MovePicker movePicker;
+    AttackCache cache;
 
     PVariation lpv;
     lpv.length = 0;
     pv->length = 0;
 
+    clearAttackCache(&cache);
+
     // Updates for UCI reporting
     thread->seldepth = MAX(thread->seldepth, height);
     thread->nodes++;
@@ -621,7 +714,13 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
     // Step 3. Max Draft Cutoff. If we are at the maximum search draft,
     // then end the search here with a static eval of the current board
     if (height >= MAX_PLY)
-        return evaluateBoard(board, &thread->pktable);
+        return evaluateBoard(board, &thread->pktable, &cache);
+
+#ifdef INTERLEAVE
+    // Let an interleaved search run while the Table entry is fetched
+    if (thread->fiber != NULL)
+        yieldSearchFiber(thread->fiber, board->hash);
+#endif
 
     // Step 4. Probe the Transposition Table, adjust the value, and consider cutoffs
     if ((ttHit = getTTEntry(board->hash, &ttMove, &ttValue, &ttEval, &ttDepth, &ttBound))){
@@ -635,32 +734,50 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
             return ttValue;
     }
 
+    // Track the Table hit rate for the Thread health monitor
+    thread->ttprobes += 1; thread->tthits += ttHit;
+
+    // Positions checked by the first ply of the Quiescence Search
+    // may not stand pat, and instead search every possible evasion
+    evading = depth == -1 && board->kingAttackers;
+
     // Step 5. Eval Pruning. If a static evaluation of the board will
     // exceed beta, then we can stop the search here. Also, if the static
     // eval exceeds alpha, we can call our static eval the new alpha
     best = eval = ttHit && ttEval != VALUE_NONE ? ttEval
-                : evaluateBoard(board, &thread->pktable);
-    alpha = MAX(alpha, eval);
-    if (alpha >= beta) return eval;
-
-    // Step 6. Delta Pruning. Even the best possible capture and or promotion
-    // combo with the additional boost of the futility margin would still fail
-    margin = alpha - eval - QFutilityMargin;
-    if (bestTacticalMoveValue(board) < margin)
-        return eval;
+                : evaluateBoard(board, &thread->pktable, &cache);
+
+    if (evading) best = -MATE + height;
+
+    else {
+
+        alpha = MAX(alpha, eval);
+        if (alpha >= beta) return eval;
+
+        // Step 6. Delta Pruning. Even the best possible capture and or promotion
+        // combo with the additional boost of the futility margin would still fail
+        margin = alpha - eval - QFutilityMargin;
+        if (bestTacticalMoveValue(board) < margin)
+            return eval;
+    }
 
     // Step 7. Move Generation and Looping. Generate all tactical moves
     // and return those which are winning via SEE, and also strong enough
-    // the margin computed in the Delta Pruning step found above to beat
-    initNoisyMovePicker(&movePicker, thread, MAX(QSEEMargin, margin));
-    while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE) {
+    // the margin computed in the Delta Pruning step found above to beat.
+    // Evasions are found by a normal Move Picker, which includes quiets,
+    // and the first ply follows the tactical moves with the quiet checks
+    if (evading) initMovePicker(&movePicker, thread, &cache, ttMove, height);
+    else initNoisyMovePicker(&movePicker, thread, &cache, MAX(QSEEMargin, margin));
+
+    while ((move = selectNextMove(&movePicker, board, !evading)) != NONE_MOVE
+           || (move = nextQuietCheck(board, &cache, checks, &i, &size, depth)) != NONE_MOVE) {
 
         // Apply move, skip if move is illegal
         if (!apply(thread, board, move, height))
             continue;
 
         // Search next depth
-        value = -qsearch(thread, &lpv, -beta, -alpha, height+1);
+        value = -qsearch(thread, &lpv, -beta, -alpha, depth-1, height+1);
 
         // Revert the board state
         revert(thread, board, move, height);
@@ -688,6 +805,27 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
     return best;
 }
 
+uint16_t nextQuietCheck(Board* board, AttackCache* cache, uint16_t* checks, int* index, int* size, int depth){
+
+    // Step 8. Quiet Checks. Only in the first ply of the Quiescence Search,
+    // and only once the tactical moves failed to produce a cutoff, will we
+    // generate the quiet checks, skipping those which would hang the piece
+    if (depth != 0) return NONE_MOVE;
+
+    if (*size == -1) {
+        *size = 0;
+        genAllQuietChecks(board, checks, size, cache);
+    }
+
+    while (*index < *size){
+        uint16_t move = checks[(*index)++];
+        if (staticExchangeEvaluation(board, move, 0))
+            return move;
+    }
+
+    return NONE_MOVE;
+}
+
 int staticExchangeEvaluation(Board* board, uint16_t move, int threshold){
 
     int from, to, type, ptype, colour, balance, nextVictim;
@@ -859,7 +997,7 @@ int moveIsSingular(Thread* thread, uint16_t ttMove, int ttValue, int depth, int
     revert(thread, board, ttMove, height);
 
     // Iterate and check all moves other than the table move
-    initMovePicker(&movePicker, thread, NONE_MOVE, height);
+    initMovePicker(&movePicker, thread, NULL, NONE_MOVE, height);
     while ((move = selectNextMove(&movePicker, board, 0)) != NONE_MOVE){
 
         // Skip the table move
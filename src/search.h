@@ -45,13 +45,17 @@ void initSearch();
 
 void getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t *best, uint16_t *ponder);
 
+void warmSearch(Thread* threads, Board* board, uint16_t best, uint16_t ponder);
+
 void* iterativeDeepening(void* vthread);
 
 int aspirationWindow(Thread* thread, int depth, int lastValue);
 
 int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int height);
 
-int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height);
+int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int height);
+
+uint16_t nextQuietCheck(Board* board, AttackCache* cache, uint16_t* checks, int* index, int* size, int depth);
 
 int staticExchangeEvaluation(Board* board, uint16_t move, int threshold);
 
@@ -0,0 +1,188 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "search.h"
+#include "suspend.h"
+#include "thread.h"
+#include "transposition.h"
+#include "types.h"
+#include "writer.h"
+
+
+// A suspended search is a SuspendHeader, the Board, the SearchInfo of the
+// last completed depth, the search state of each Thread, and finally the TT
+static const char SuspendMagic[16] = "Ethereal SS v1";
+
+static char SuspendPath[4096];
+static volatile int SuspendPending;
+
+static SearchInfo ResumeInfo;
+static int ResumePending;
+
+
+static size_t threadStateSize() {
+    return sizeof(HistoryTable) + sizeof(CMHistoryTable) + sizeof(FUHistoryTable) + sizeof(GainHistoryTable)
+         + sizeof(CounterMoveTable) + sizeof(uint16_t) * 2 * (MAX_PLY + 5);
+}
+
+static int transferThread(FILE *file, Thread *thread, int writing) {
+
+    // Everything which guides the move ordering and pruning, but not caches
+    // like the Pawn King Table, which are refilled very quickly once resumed.
+    // Depths and values come from the SearchInfo, so that every Thread will
+    // continue from the last depth which was completed by the main thread
+    struct { void *ptr; size_t size; } fields[] = {
+        { &thread->history,   sizeof(HistoryTable)     },
+        { &thread->cmhistory, sizeof(CMHistoryTable)   },
+        { &thread->fuhistory, sizeof(FUHistoryTable)   },
+        { &thread->gains,     sizeof(GainHistoryTable) },
+        { &thread->cmtable,   sizeof(CounterMoveTable) },
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+        if ((writing ? fwrite(fields[i].ptr, fields[i].size, 1, file)
+                     : fread(fields[i].ptr, fields[i].size, 1, file)) != 1)
+            return 0;
+
+    // Killer moves live in the SearchStack, among pointers we cannot save
+    for (int i = 0; i < MAX_PLY + 5; i++)
+        if ((writing ? fwrite(thread->_stack[i].killers, sizeof(uint16_t), 2, file)
+                     : fread(thread->_stack[i].killers, sizeof(uint16_t), 2, file)) != 2)
+            return 0;
+
+    return 1;
+}
+
+void requestSuspend(char *path) {
+    strncpy(SuspendPath, path, sizeof(SuspendPath) - 1);
+    SuspendPending = 1;
+}
+
+void suspendIfRequested(Thread *threads, Board *board, SearchInfo *info) {
+
+    if (!SuspendPending) return;
+
+    suspendSearch(SuspendPath, threads, board, info);
+    SuspendPending = 0;
+}
+
+int suspendSearch(char *path, Thread *threads, Board *board, SearchInfo *info) {
+
+    FILE *fout;
+    SearchInfo empty;
+    SuspendHeader header;
+    int success;
+
+    // Without a search, only the tables are saved and a resume starts over
+    if (info == NULL) {
+        memset(&empty, 0, sizeof(SearchInfo));
+        info = &empty;
+    }
+
+    memset(&header, 0, sizeof(SuspendHeader));
+    memcpy(header.magic, SuspendMagic, sizeof(SuspendMagic));
+    header.nthreads   = threads[0].nthreads;
+    header.boardSize  = sizeof(Board);
+    header.infoSize   = sizeof(SearchInfo);
+    header.threadSize = threadStateSize();
+
+    if ((fout = fopen(path, "wb")) == NULL) {
+        writerPrintf("info string unable to open %s\n", path);
+        return 0;
+    }
+
+    success = fwrite(&header, sizeof(SuspendHeader), 1, fout) == 1
+           && fwrite(board, sizeof(Board), 1, fout) == 1
+           && fwrite(info, sizeof(SearchInfo), 1, fout) == 1;
+
+    for (int i = 0; success && i < threads[0].nthreads; i++)
+        success = transferThread(fout, &threads[i], 1);
+
+    success = success && saveTT(fout);
+    success = (fclose(fout) == 0) && success;
+
+    if (success) writerPrintf("info string suspended depth %d to %s\n", info->depth, path);
+    else writerPrintf("info string unable to write %s\n", path);
+
+    return success;
+}
+
+int resumeSearch(char *path, Thread *threads, Board *board) {
+
+    FILE *fin;
+    SuspendHeader header;
+    int success;
+
+    if ((fin = fopen(path, "rb")) == NULL) {
+        writerPrintf("info string unable to open %s\n", path);
+        return 0;
+    }
+
+    // Refuse files written by a different build of Ethereal
+    if (   fread(&header, sizeof(SuspendHeader), 1, fin) != 1
+        || memcmp(header.magic, SuspendMagic, sizeof(SuspendMagic))
+        || header.boardSize  != sizeof(Board)
+        || header.infoSize   != sizeof(SearchInfo)
+        || header.threadSize != threadStateSize()) {
+        writerPrintf("info string %s is not a suspended search\n", path);
+        fclose(fin);
+        return 0;
+    }
+
+    success = fread(board, sizeof(Board), 1, fin) == 1
+           && fread(&ResumeInfo, sizeof(SearchInfo), 1, fin) == 1;
+
+    // Restore as many Threads as we have. Extra saved Threads are skipped,
+    // while extra Threads of ours simply keep their current tables
+    for (uint32_t i = 0; success && i < header.nthreads; i++)
+        success = i < (uint32_t)threads[0].nthreads ? transferThread(fin, &threads[i], 0)
+                : fseek(fin, (long)threadStateSize(), SEEK_CUR) == 0;
+
+    success = success && loadTT(fin);
+    fclose(fin);
+
+    if (!success) {
+        writerPrintf("info string unable to read %s\n", path);
+        return 0;
+    }
+
+    ResumePending = ResumeInfo.depth > 0;
+
+    writerPrintf("info string resumed depth %d from %s\n", ResumeInfo.depth, path);
+    return 1;
+}
+
+void resumeSearchInfo(SearchInfo *info) {
+
+    if (!ResumePending) return;
+
+    // Continue from the last completed depth, but keep our own time data
+    info->depth = ResumeInfo.depth;
+    memcpy(info->values, ResumeInfo.values, sizeof(info->values));
+    memcpy(info->bestMoves, ResumeInfo.bestMoves, sizeof(info->bestMoves));
+    memcpy(info->ponderMoves, ResumeInfo.ponderMoves, sizeof(info->ponderMoves));
+
+    ResumePending = 0;
+}
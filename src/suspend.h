@@ -0,0 +1,38 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+struct SuspendHeader {
+    char magic[16];
+    uint32_t nthreads;
+    uint32_t boardSize;
+    uint32_t infoSize;
+    uint32_t threadSize;
+};
+
+void requestSuspend(char *path);
+void suspendIfRequested(Thread *threads, Board *board, SearchInfo *info);
+int suspendSearch(char *path, Thread *threads, Board *board, SearchInfo *info);
+int resumeSearch(char *path, Thread *threads, Board *board);
+void resumeSearchInfo(SearchInfo *info);
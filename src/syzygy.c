@@ -17,24 +17,49 @@
 */
 
 #include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "bitboards.h"
 #include "board.h"
 #include "fathom/tbprobe.h"
 #include "move.h"
 #include "movegen.h"
+#include "search.h"
+#include "syzygy.h"
+#include "thread.h"
+#include "time.h"
 #include "types.h"
 #include "uci.h"
+#include "writer.h"
 
 
 unsigned TB_PROBE_DEPTH; // Set by UCI options
 
+unsigned TB_PROBE_BUDGET; // Set by UCI options
+
+volatile unsigned TB_EFFECTIVE_DEPTH; // Adjusted by the main thread
+
 extern unsigned TB_LARGEST; // Set by Fathom in tb_init()
 
+extern unsigned TB_NUM_TABLES; // Set by Fathom in tb_init()
+
+extern volatile int IS_WARMING; // Defined by Search.c
+
+static uint64_t LastProbeTime, LastProbeCount, LastSearchTime;
+
+static pthread_t TablebaseLoader;
+
+static int TablebasesLoading; // Only used by the UCI thread
 
-unsigned tablebasesProbeWDL(Board* board, int depth, int height){
+
+unsigned tablebasesProbeWDL(Thread* thread, int depth, int height){
+
+    Board* const board = &thread->board;
 
     // Tap into Fathom's API routines. Fathom checks for empty
     // castling rights and no enpassant square, so unlike Stockfish
@@ -50,7 +75,9 @@ unsigned tablebasesProbeWDL(Board* board, int depth, int height){
     // we have just zeroed on the last move, and we have few enough
     // pieces to be in the table. Finally, if our cardinality is the
     // largest possible for our tables, then only probe if our depth
-    // is less than TB_PROBE_DEPTH, to reduce throughput on the HDD
+    // is at least TB_EFFECTIVE_DEPTH, to reduce throughput on the HDD.
+    // TB_EFFECTIVE_DEPTH is TB_PROBE_DEPTH, unless SyzygyProbeBudget
+    // is set, in which case it is adjusted based on probe latency
 
     // Also, we avoid probing at the Root because the WDL tables do
     // not return a best move for the PV, but only a known score
@@ -63,9 +90,25 @@ unsigned tablebasesProbeWDL(Board* board, int depth, int height){
         ||  board->castleRights != 0
         ||  board->fiftyMoveRule != 0
         ||  cardinality > (int)TB_LARGEST
-        || (cardinality == (int)TB_LARGEST && depth < (int)TB_PROBE_DEPTH))
+        || (cardinality == (int)TB_LARGEST && depth < (int)TB_EFFECTIVE_DEPTH))
         return TB_RESULT_FAILED;
 
+    // Time the probe only when the depth controller needs the data
+    if (TB_PROBE_BUDGET) {
+
+        uint64_t start = getPreciseTime();
+        unsigned result = tablebasesProbeFathomWDL(board);
+
+        thread->tbprobes += 1;
+        thread->tbtime   += getPreciseTime() - start;
+        return result;
+    }
+
+    return tablebasesProbeFathomWDL(board);
+}
+
+unsigned tablebasesProbeFathomWDL(Board* board){
+
     return tb_probe_wdl(
         board->colours[WHITE],
         board->colours[BLACK],
@@ -82,6 +125,58 @@ unsigned tablebasesProbeWDL(Board* board, int depth, int height){
     );
 }
 
+void tablebasesNewSearch(){
+
+    // Start the controller from where it was left by the last search, since
+    // the storage hardware does not change between moves. Never probe at a
+    // lower depth than the user has requested with SyzygyProbeDepth
+    if (!TB_PROBE_BUDGET || TB_EFFECTIVE_DEPTH < TB_PROBE_DEPTH)
+        TB_EFFECTIVE_DEPTH = TB_PROBE_DEPTH;
+
+    LastProbeTime = LastProbeCount = LastSearchTime = 0ull;
+}
+
+void tablebasesUpdateProbeDepth(Thread* threads){
+
+    uint64_t probeTime = 0ull, probeCount = 0ull, searchTime, probes;
+    double fraction, latency;
+
+    // Controller is disabled without a time budget
+    if (!TB_PROBE_BUDGET) return;
+
+    for (int i = 0; i < threads[0].nthreads; i++) {
+        probeTime  += threads[i].tbtime;
+        probeCount += threads[i].tbprobes;
+    }
+
+    // Total thread time spent in this search, in nanoseconds
+    searchTime = (uint64_t)(1e6 * elapsedTime(threads[0].info)) * threads[0].nthreads;
+
+    // Only look at the probes since the last adjustment, so that
+    // the controller is able to react to changes in the depth
+    if ((probes = probeCount - LastProbeCount) == 0ull) return;
+    fraction = (probeTime - LastProbeTime) / (double)MAX(1ull, searchTime - LastSearchTime);
+    latency  = (probeTime - LastProbeTime) / (1e3 * probes);
+
+    LastProbeTime  = probeTime;
+    LastProbeCount = probeCount;
+    LastSearchTime = searchTime;
+
+    // Probes are too expensive, so push them further from the leaves
+    if (100.0 * fraction > TB_PROBE_BUDGET && TB_EFFECTIVE_DEPTH < MAX_PLY - 1)
+        TB_EFFECTIVE_DEPTH += 1;
+
+    // Probes are cheap, so try probing closer to the leaves again
+    else if (200.0 * fraction < TB_PROBE_BUDGET && TB_EFFECTIVE_DEPTH > TB_PROBE_DEPTH)
+        TB_EFFECTIVE_DEPTH -= 1;
+
+    // Warming searches are not reported to the interface
+    if (IS_WARMING) return;
+
+    writerPrintfInfo("info string SyzygyProbeDepth %u latency %.1fus probes %"PRIu64" usage %.2f%%\n",
+                     TB_EFFECTIVE_DEPTH, latency, probes, 100.0 * fraction);
+}
+
 int tablebasesProbeDTZ(Board* board, uint16_t* move){
 
     int i, size = 0;
@@ -161,3 +256,37 @@ int tablebasesProbeDTZ(Board* board, uint16_t* move){
     // we failed to probe then nothing is going to break
     assert(0); return 0;
 }
+
+static void* tablebasesLoader(void* vpath){
+
+    char* path = (char*)vpath;
+
+    tb_init(path);
+    writerPrintf("info string found %u tablebases\n", TB_NUM_TABLES);
+    writerPrintf("info string set SyzygyPath to %s\n", path);
+
+    free(path);
+    return NULL;
+}
+
+void tablebasesLoad(const char* path){
+
+    char* copy = malloc(strlen(path) + 1);
+    strcpy(copy, path);
+
+    // Tables are loaded in the background, so that the UCI thread can keep
+    // handling commands. Anything which probes the tables must wait first
+    tablebasesWaitForLoad();
+
+    if (pthread_create(&TablebaseLoader, NULL, &tablebasesLoader, copy))
+        tablebasesLoader(copy);
+    else TablebasesLoading = 1;
+}
+
+void tablebasesWaitForLoad(){
+
+    if (TablebasesLoading)
+        pthread_join(TablebaseLoader, NULL);
+
+    TablebasesLoading = 0;
+}
@@ -23,6 +23,16 @@
 
 int tablebasesProbeDTZ(Board* board, uint16_t* move);
 
-unsigned tablebasesProbeWDL(Board* board, int depth, int height);
+unsigned tablebasesProbeWDL(Thread* thread, int depth, int height);
+
+unsigned tablebasesProbeFathomWDL(Board* board);
+
+void tablebasesNewSearch();
+
+void tablebasesUpdateProbeDepth(Thread* threads);
+
+void tablebasesLoad(const char* path);
+
+void tablebasesWaitForLoad();
 
 #endif
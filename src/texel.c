@@ -19,6 +19,7 @@
 #ifdef TUNE
 
 #include <math.h>
+#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,52 +43,56 @@ TexelTuple* TupleStack;
 int TupleStackSize = STACKSIZE;
 
 // Tap into evaluate()
-extern EvalTrace T, EmptyTrace;
-
-extern const int PawnValue;
-extern const int KnightValue;
-extern const int BishopValue;
-extern const int RookValue;
-extern const int QueenValue;
-extern const int KingValue;
-extern const int PawnPSQT32[32];
-extern const int KnightPSQT32[32];
-extern const int BishopPSQT32[32];
-extern const int RookPSQT32[32];
-extern const int QueenPSQT32[32];
-extern const int KingPSQT32[32];
-extern const int PawnCandidatePasser[2][8];
-extern const int PawnIsolated;
-extern const int PawnStacked;
-extern const int PawnBackwards[2];
-extern const int PawnConnected32[32];
-extern const int KnightOutpost[2];
-extern const int KnightBehindPawn;
-extern const int KnightMobility[9];
-extern const int BishopPair;
-extern const int BishopRammedPawns;
-extern const int BishopOutpost[2];
-extern const int BishopBehindPawn;
-extern const int BishopMobility[14];
-extern const int RookFile[2];
-extern const int RookOnSeventh;
-extern const int RookMobility[15];
-extern const int QueenMobility[28];
-extern const int KingDefenders[12];
-extern const int KingShelter[2][8][8];
-extern const int KingStorm[2][4][8];
-extern const int PassedPawn[2][2][8];
-extern const int PassedFriendlyDistance[8];
-extern const int PassedEnemyDistance[8];
-extern const int PassedSafePromotionPath;
-extern const int ThreatWeakPawn;
-extern const int ThreatMinorAttackedByPawn;
-extern const int ThreatMinorAttackedByMinor;
-extern const int ThreatMinorAttackedByMajor;
-extern const int ThreatRookAttackedByLesser;
-extern const int ThreatQueenAttackedByOne;
-extern const int ThreatOverloadedPieces;
-extern const int ThreatByPawnPush;
+extern EvalTrace T;
+extern _Thread_local SparseTrace ST;
+
+// Tuner index for each term of the EvalTrace, or -1 when not tuned
+int TraceIndices[sizeof(EvalTrace) / sizeof(int) / COLOUR_NB];
+
+extern int PawnValue;
+extern int KnightValue;
+extern int BishopValue;
+extern int RookValue;
+extern int QueenValue;
+extern int KingValue;
+extern int PawnPSQT32[32];
+extern int KnightPSQT32[32];
+extern int BishopPSQT32[32];
+extern int RookPSQT32[32];
+extern int QueenPSQT32[32];
+extern int KingPSQT32[32];
+extern int PawnCandidatePasser[2][8];
+extern int PawnIsolated;
+extern int PawnStacked;
+extern int PawnBackwards[2];
+extern int PawnConnected32[32];
+extern int KnightOutpost[2];
+extern int KnightBehindPawn;
+extern int KnightMobility[9];
+extern int BishopPair;
+extern int BishopRammedPawns;
+extern int BishopOutpost[2];
+extern int BishopBehindPawn;
+extern int BishopMobility[14];
+extern int RookFile[2];
+extern int RookOnSeventh;
+extern int RookMobility[15];
+extern int QueenMobility[28];
+extern int KingDefenders[12];
+extern int KingShelter[2][8][8];
+extern int KingStorm[2][4][8];
+extern int PassedPawn[2][2][8];
+extern int PassedFriendlyDistance[8];
+extern int PassedEnemyDistance[8];
+extern int PassedSafePromotionPath;
+extern int ThreatWeakPawn;
+extern int ThreatMinorAttackedByPawn;
+extern int ThreatMinorAttackedByMinor;
+extern int ThreatMinorAttackedByMajor;
+extern int ThreatRookAttackedByLesser;
+extern int ThreatQueenAttackedByOne;
+extern int ThreatOverloadedPieces;
+extern int ThreatByPawnPush;
 
 void runTexelTuning(Thread *thread) {
 
@@ -114,6 +119,11 @@ void runTexelTuning(Thread *thread) {
     printf("\n\nInitializing Texel Entries from FENS...");
     initTexelEntries(tes, thread);
 
+    if (LABELDEPTH > 0) {
+        printf("\n\nSearching FENS for Score Labels...");
+        initSearchLabels(tes);
+    }
+
     printf("\n\nFetching Current Evaluation Terms as a Starting Point...");
     initCurrentParameters(cparams);
 
@@ -157,9 +167,13 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
     Undo undo[1];
     Limits limits;
     char line[128];
-    int i, j, k, coeffs[NTERMS];
+    int i, j, ntuples;
+    TexelTuple tuples[MAX_TRACE_RECORDS];
     FILE *fin = fopen("FENS", "r");
 
+    // Map each term of the EvalTrace to its index in the tuner
+    initTraceIndices();
+
     // Initialize the thread for the search
     thread->limits = &limits; thread->depth  = 0;
 
@@ -184,7 +198,7 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
 
         // Resolve FEN to a quiet position
         boardFromFEN(&thread->board, line);
-        qsearch(thread, &thread->pv, -MATE, MATE, 0);
+        qsearch(thread, &thread->pv, -MATE, MATE, 0, 0);
         for (j = 0; j < thread->pv.length; j++)
             applyMove(&thread->board, thread->pv.line[j], undo);
 
@@ -202,43 +216,124 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
         tes[i].phase = (tes[i].phase * 256 + 12) / 24.0;
 
         // Vectorize the evaluation coefficients and save the eval
-        // relative to WHITE. We must first clear the coeff vector.
-        T = EmptyTrace;
-        tes[i].eval = evaluateBoard(&thread->board, NULL);
+        // relative to WHITE. Each evaluation starts a new trace
+        tes[i].eval = evaluateBoard(&thread->board, NULL, NULL);
         if (thread->board.turn == BLACK) tes[i].eval *= -1;
-        initCoefficients(coeffs);
+        ntuples = initCoefficients(tuples);
 
-        // Count up the non zero coefficients
-        for (k = 0, j = 0; j < NTERMS; j++)
-            k += coeffs[j] != 0;
+        // Allocate and initialize the Texel Tuples
+        updateMemory(&tes[i], ntuples);
+        memcpy(tes[i].tuples, tuples, ntuples * sizeof(TexelTuple));
+    }
+
+    fclose(fin);
+}
+
+void initSearchLabels(TexelEntry *tes) {
+
+    Limits limits;
+    SearchInfo info;
+    char (*fens)[128] = malloc(LABELBATCH * sizeof(*fens));
+    Thread *threads = createThreadPool(omp_get_max_threads());
+    FILE *fin = fopen("FENS", "r");
 
-        // Allocate Tuples
-        updateMemory(&tes[i], k);
+    // No limits are set, so searches are never terminated early
+    memset(&limits, 0, sizeof(Limits));
+    memset(&info, 0, sizeof(SearchInfo));
+    for (int i = 0; i < threads[0].nthreads; i++)
+        threads[i].limits = &limits, threads[i].info = &info;
 
-        // Initialize the Texel Tuples
-        for (k = 0, j = 0; j < NTERMS; j++) {
-            if (coeffs[j] != 0){
-                tes[i].tuples[k].index = j;
-                tes[i].tuples[k++].coeff = coeffs[j];
+    for (int start = 0; start < NPOSITIONS; start += LABELBATCH) {
+
+        int count = MIN(LABELBATCH, NPOSITIONS - start);
+
+        // Read the next batch of positions, in the same order as before
+        for (int i = 0; i < count; i++) {
+            if (fgets(fens[i], 128, fin) == NULL) {
+                printf("Unable to read line #%d\n", start + i);
+                exit(EXIT_FAILURE);
             }
         }
+
+        // Search each position with whichever Thread is free
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < count; i++)
+            tes[start + i].score = searchLabel(&threads[omp_get_thread_num()], fens[i]);
+
+        printf("\rSearching FENS for Score Labels...  [%7d of %7d]", start + count, NPOSITIONS);
     }
 
     fclose(fin);
+    free(threads);
+    free(fens);
+}
+
+double searchLabel(Thread *thread, char *fen) {
+
+    int value = 0;
+
+    boardFromFEN(&thread->board, fen);
+
+    // Iterate up to the depth limit, for the sake of move ordering
+    for (thread->depth = 1; thread->depth <= LABELDEPTH; thread->depth++)
+        value = search(thread, &thread->pv, -MATE, MATE, thread->depth, 0);
+
+    // Save the score relative to WHITE, like the evaluation
+    return thread->board.turn == WHITE ? value : -value;
 }
 
-void initCoefficients(int coeffs[NTERMS]) {
+void initTraceIndices() {
 
     int i = 0; // EXECUTE_ON_TERMS will update i accordingly
 
-    EXECUTE_ON_TERMS(INIT_COEFF);
+    // Terms which are not being tuned are ignored when tracing
+    for (int j = 0; j < (int)(sizeof(TraceIndices) / sizeof(int)); j++)
+        TraceIndices[j] = -1;
+
+    EXECUTE_ON_TERMS(INIT_INDEX);
 
     if (i != NTERMS){
-        printf("Error in initCoefficients(): i = %d ; NTERMS = %d\n", i, NTERMS);
+        printf("Error in initTraceIndices(): i = %d ; NTERMS = %d\n", i, NTERMS);
         exit(EXIT_FAILURE);
     }
 }
 
+int initCoefficients(TexelTuple *tuples) {
+
+    static int coeffs[NTERMS], seen[NTERMS];
+    int index, count, ntuples = 0, ntouched = 0;
+    int touched[MAX_TRACE_RECORDS];
+
+    // Sum the traced counts for each term, as WHITE minus BLACK. The
+    // work done is proportional to the number of terms actually used
+    for (int i = 0; i < ST.length; i++) {
+
+        if ((index = TraceIndices[ST.records[i].offset / COLOUR_NB]) < 0)
+            continue;
+
+        if (!seen[index])
+            seen[index] = 1, touched[ntouched++] = index;
+
+        count = ST.records[i].count;
+        coeffs[index] += ST.records[i].offset % COLOUR_NB == WHITE ? count : -count;
+    }
+
+    // Save the non zero coefficients, and clear out for the next position
+    for (int i = 0; i < ntouched; i++) {
+
+        index = touched[i];
+
+        if (coeffs[index] != 0) {
+            tuples[ntuples  ].index = index;
+            tuples[ntuples++].coeff = coeffs[index];
+        }
+
+        coeffs[index] = seen[index] = 0;
+    }
+
+    return ntuples;
+}
+
 void initCurrentParameters(TexelVector cparams) {
 
     int i = 0; // EXECUTE_ON_TERMS will update i accordingly
@@ -336,6 +431,9 @@ double completeEvaluationError(TexelEntry *tes, double K) {
 
     double total = 0.0;
 
+    // K is fit against the game results alone. The score labels are converted
+    // using this K, so fitting against them too would pull K towards zero
+
     #pragma omp parallel shared(total)
     {
         #pragma omp for schedule(static, NPOSITIONS / NPARTITIONS) reduction(+:total)
@@ -354,7 +452,7 @@ double completeLinearError(TexelEntry *tes, TexelVector params, double K) {
     {
         #pragma omp for schedule(static, NPOSITIONS / NPARTITIONS) reduction(+:total)
         for (int i = 0; i < NPOSITIONS; i++)
-            total += pow(tes[i].result - sigmoid(K, linearEvaluation(&tes[i], params)), 2);
+            total += pow(blendedResult(&tes[i], K) - sigmoid(K, linearEvaluation(&tes[i], params)), 2);
     }
 
     return total / (double)NPOSITIONS;
@@ -363,7 +461,7 @@ double completeLinearError(TexelEntry *tes, TexelVector params, double K) {
 double singleLinearError(TexelEntry *te, TexelVector params, double K) {
     double sigm = sigmoid(K, linearEvaluation(te, params));
     double sigmprime = sigm * (1 - sigm);
-    return (te->result - sigm) * sigmprime;
+    return (blendedResult(te, K) - sigm) * sigmprime;
 }
 
 double linearEvaluation(TexelEntry *te, TexelVector params) {
@@ -378,6 +476,14 @@ double linearEvaluation(TexelEntry *te, TexelVector params) {
     return te->eval + ((mg * (256 - te->phase) + eg * te->phase) / 256.0);
 }
 
+double blendedResult(TexelEntry *te, double K) {
+
+    // Without score labels we can only train against the game result
+    if (LABELDEPTH <= 0) return te->result;
+
+    return LAMBDA * te->result + (1.0 - LAMBDA) * sigmoid(K, te->score);
+}
+
 double sigmoid(double K, double S) {
     return 1.0 / (1.0 + pow(10.0, -K * S / 400.0));
 }
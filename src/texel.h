@@ -32,6 +32,10 @@
 #define BATCHSIZE   (   2048) // FENs per mini-batch
 #define NPOSITIONS  (7500000) // Total FENS in the book
 
+#define LABELDEPTH  (      0) // Search depth for score labels, 0 to skip
+#define LABELBATCH  (  16384) // FENs searched in parallel per batch
+#define LAMBDA      (    1.0) // Weight of the game result in the labels
+
 #define STACKSIZE ((int)((double) NPOSITIONS * NTERMS / 32))
 
 #define TunePawnValue                   (1)
@@ -86,7 +90,7 @@ struct TexelTuple {
 
 struct TexelEntry {
     int ntuples;
-    double result;
+    double result, score;
     double eval, phase;
     double factors[PHASE_NB];
     TexelTuple* tuples;
@@ -97,7 +101,10 @@ typedef double TexelVector[NTERMS][PHASE_NB];
 void runTexelTuning(Thread* thread);
 
 void initTexelEntries(TexelEntry *tes, Thread *thread);
-void initCoefficients(int coeffs[NTERMS]);
+void initSearchLabels(TexelEntry *tes);
+double searchLabel(Thread *thread, char *fen);
+void initTraceIndices();
+int initCoefficients(TexelTuple *tuples);
 void initCurrentParameters(TexelVector cparams);
 
 void updateMemory(TexelEntry *te, int size);
@@ -110,6 +117,7 @@ double completeEvaluationError(TexelEntry *tes, double K);
 double completeLinearError(TexelEntry *tes, TexelVector params, double K);
 double singleLinearError(TexelEntry *te, TexelVector params, double K);
 double linearEvaluation(TexelEntry *te, TexelVector params);
+double blendedResult(TexelEntry *te, double K);
 double sigmoid(double K, double S);
 
 void printParameters(TexelVector params, TexelVector cparams);
@@ -141,25 +149,27 @@ void printParameters_3(char *name, int params[NTERMS][PHASE_NB], int i, int A, i
         INIT_PARAM_2(term[_c], B, C);                           \
 } while (0)
 
-// Initalize Coefficients from an N dimensional array
+// Initalize Trace Indices from an N dimensional array
+
+#define TRACE_SLOT(ptr) ((int)((ptr) - (int*) &T) / COLOUR_NB)
 
-#define INIT_COEFF_0(term) do {                                 \
-    coeffs[i++] = T.term[WHITE] - T.term[BLACK];                \
+#define INIT_INDEX_0(term) do {                                 \
+    TraceIndices[TRACE_SLOT(&T.term[WHITE])] = i++;             \
 } while (0)
 
-#define INIT_COEFF_1(term, A) do {                              \
+#define INIT_INDEX_1(term, A) do {                              \
     for (int _a = 0; _a < A; _a++)                              \
-        coeffs[i++] = T.term[_a][WHITE] - T.term[_a][BLACK];    \
+        TraceIndices[TRACE_SLOT(&T.term[_a][WHITE])] = i++;     \
 } while (0)
 
-#define INIT_COEFF_2(term, A, B) do {                           \
+#define INIT_INDEX_2(term, A, B) do {                           \
     for (int _b = 0; _b < A; _b++)                              \
-        INIT_COEFF_1(term[_b], B);                              \
+        INIT_INDEX_1(term[_b], B);                              \
 } while (0)
 
-#define INIT_COEFF_3(term, A, B, C) do {                        \
+#define INIT_INDEX_3(term, A, B, C) do {                        \
     for (int _c = 0; _c < A; _c++)                              \
-        INIT_COEFF_2(term[_c], B, C);                           \
+        INIT_INDEX_2(term[_c], B, C);                           \
 } while (0)
 
 // Print Parameters of an N dimensional array
@@ -17,6 +17,7 @@
 */
 
 #include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,6 +28,7 @@
 #include "transposition.h"
 #include "types.h"
 #include "windows.h"
+#include "writer.h"
 
 Thread* createThreadPool(int nthreads){
 
@@ -39,15 +41,11 @@ Thread* createThreadPool(int nthreads){
         threads[i].threads = threads;
         threads[i].nthreads = nthreads;
 
-        // Offset stacks so root position can look backwards
-        threads[i].evalStack = &(threads[i]._evalStack[4]);
-        threads[i].moveStack = &(threads[i]._moveStack[4]);
-        threads[i].pieceStack = &(threads[i]._pieceStack[4]);
+        // Offset the stack so root position can look backwards
+        threads[i].stack = &(threads[i]._stack[4]);
 
-        // Zero out the stack, most importantly the first four slots
-        memset(&threads[i]._evalStack, 0, sizeof(int) * (MAX_PLY + 4));
-        memset(&threads[i]._moveStack, 0, sizeof(uint16_t) * (MAX_PLY + 4));
-        memset(&threads[i]._pieceStack, 0, sizeof(int) * (MAX_PLY + 4));
+        // Searches run alone on their OS thread unless interleaved
+        threads[i].fiber = NULL;
     }
 
     resetThreadPool(threads);
@@ -62,10 +60,11 @@ void resetThreadPool(Thread* threads){
     // calls in order to ensure deterministic behaviour
 
     for (int i = 0; i < threads[0].nthreads; i++){
-        memset(&threads[i].killers,   0, sizeof(KillerTable     ));
+        memset(&threads[i]._stack,    0, sizeof(threads[i]._stack));
         memset(&threads[i].history,   0, sizeof(HistoryTable    ));
         memset(&threads[i].cmhistory, 0, sizeof(CMHistoryTable  ));
         memset(&threads[i].fuhistory, 0, sizeof(FUHistoryTable  ));
+        memset(&threads[i].gains,     0, sizeof(GainHistoryTable));
         memset(&threads[i].cmtable,   0, sizeof(CounterMoveTable));
         memset(&threads[i].pktable,   0, sizeof(PawnKingTable   ));
     }
@@ -85,13 +84,45 @@ void newSearchThreadPool(Thread* threads, Board* board, Limits* limits, SearchIn
         // Make our own copy of the original position
         memcpy(&threads[i].board, board, sizeof(Board));
 
-        // Zero out our depth and stat tracking
-        threads[i].depth  = 0;
+        // Start from the last completed depth, which is zero unless we
+        // are resuming a suspended search, and zero out our stat tracking
+        threads[i].depth  = info->depth;
+        if (info->depth) threads[i].value = info->values[info->depth];
         threads[i].nodes  = 0ull;
         threads[i].tbhits = 0ull;
+
+        // Zero out the Syzygy probe timing data
+        threads[i].tbprobes = 0ull;
+        threads[i].tbtime   = 0ull;
+
+        // Zero out the data used by the Thread health monitor
+        threads[i].ttprobes  = 0ull;
+        threads[i].tthits    = 0ull;
+        threads[i].lastcheck = info->startTime;
     }
 }
 
+void printThreadFootprint(Thread* threads){
+
+    // Sizes of the per-thread tables, which are duplicated for every Thread
+    // and every engine instance on a host, and so compete for the caches
+    const struct { const char *name; size_t size; } tables[] = {
+        { "history",   sizeof(HistoryTable)          },
+        { "cmhistory", sizeof(CMHistoryTable)        },
+        { "fuhistory", sizeof(FUHistoryTable)        },
+        { "gains",     sizeof(GainHistoryTable)      },
+        { "cmtable",   sizeof(CounterMoveTable)      },
+        { "pktable",   sizeof(PawnKingTable)         },
+        { "stack",     sizeof(threads[0]._stack)     },
+    };
+
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++)
+        writerPrintf("info string footprint %s %zu KB\n", tables[i].name, tables[i].size >> 10);
+
+    writerPrintf("info string footprint thread %zu KB total %zu KB\n",
+        sizeof(Thread) >> 10, (sizeof(Thread) * threads[0].nthreads) >> 10);
+}
+
 uint64_t nodesSearchedThreadPool(Thread* threads){
 
     uint64_t nodes = 0ull;
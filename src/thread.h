@@ -26,6 +26,14 @@
 #include "transposition.h"
 #include "types.h"
 
+struct SearchStack {
+    int eval, piece;
+    uint16_t move, killers[2];
+    ContinuationTable *cmhistory;
+    ContinuationTable *fuhistory;
+    Undo undo;
+};
+
 struct Thread {
 
     Limits* limits;
@@ -39,28 +47,28 @@ struct Thread {
     int seldepth;
     uint64_t nodes;
     uint64_t tbhits;
+    uint64_t tbprobes;
+    uint64_t tbtime;
+    uint64_t ttprobes;
+    uint64_t tthits;
+    double lastcheck;
+    double duty;
+    uint64_t slicestart;
 
-    int *evalStack;
-    int _evalStack[MAX_PLY+4];
-
-    uint16_t *moveStack;
-    uint16_t _moveStack[MAX_PLY+4];
-
-    int *pieceStack;
-    int _pieceStack[MAX_PLY+4];
-
-    Undo undoStack[MAX_PLY];
+    SearchStack *stack;
+    SearchStack _stack[MAX_PLY+5];
 
     jmp_buf jbuffer;
+    SearchFiber *fiber; // Set when interleaved with other searches
 
     int index;
     int nthreads;
     Thread* threads;
 
-    KillerTable killers;
     HistoryTable history;
     CMHistoryTable cmhistory;
     FUHistoryTable fuhistory;
+    GainHistoryTable gains;
     CounterMoveTable cmtable;
     PawnKingTable pktable;
 };
@@ -72,6 +80,8 @@ void resetThreadPool(Thread* threads);
 
 void newSearchThreadPool(Thread* threads, Board* board, Limits* limits, SearchInfo* info);
 
+void printThreadFootprint(Thread* threads);
+
 uint64_t nodesSearchedThreadPool(Thread* threads);
 
 uint64_t tbhitsSearchedThreadPool(Thread* threads);
@@ -0,0 +1,196 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#include "board.h"
+#include "numa.h"
+#include "thread.h"
+#include "throughput.h"
+#include "time.h"
+#include "transposition.h"
+#include "types.h"
+#include "uci.h"
+
+extern volatile int ABORT_SIGNAL; // For killing active search
+
+// Several independent single threaded searches run side by side, in the way
+// many engine instances share one host, so that the limits of the shared caches
+// and of the memory bandwidth show up in the results. Run as "throughput [depth]
+// [instances] [megabytes]", which searches the benchmark positions in each of 1,
+// 2, 4, ... instances at once, up to the given count, with each instance having
+// its own Thread and its own Table of the given size
+
+typedef struct InstanceResult {
+    uint64_t nodes;
+    double elapsed;
+} InstanceResult;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+static void makeTablesPrivate() {
+
+    // The forked instances would otherwise share the pages of the tables built
+    // by the parent, while separate engines each build their own. Writing every
+    // page back leaves each instance with a private copy to keep in the caches
+    volatile char *bytes = (volatile char*)&MainTables;
+    for (size_t i = 0; i < sizeof(EngineTables); i += 4096)
+        bytes[i] = bytes[i];
+}
+
+static InstanceResult runInstance(int depth, int megabytes) {
+
+    Limits limits;
+    InstanceResult result = {0};
+    Thread *thread;
+    double start;
+
+    makeTablesPrivate();
+    initTT(megabytes);
+
+    // Numbered as a helper, which never reports, as with the interleave tool
+    thread = createThreadPool(1);
+    thread->index = 1;
+    thread->duty  = 1.0;
+
+    // Only the depth limit is used, as with the normal benchmark
+    memset(&limits, 0, sizeof(Limits));
+    limits.limitedByDepth = 1;
+    limits.depthLimit     = depth;
+    limits.start          = getRealTime();
+
+    start = getRealTime();
+
+    for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
+        result.nodes += searchBenchmarkPosition(thread, Benchmarks[i], &limits);
+        clearTT(); // Reset TT for new search
+    }
+
+    result.elapsed = MAX(1.0, getRealTime() - start);
+    return result;
+}
+
+static int runInstances(InstanceResult *results, int count, int depth, int megabytes, double *elapsed) {
+
+    int startPipe[2], resultPipe[2], started = 0, finished = 0;
+    double start;
+    char unused;
+
+    if (pipe(startPipe) || pipe(resultPipe))
+        return 0;
+
+    fflush(stdout); // Children must not repeat our buffered output
+
+    for (started = 0; started < count; started++) {
+
+        pid_t pid = fork();
+        if (pid < 0) break;
+
+        if (pid == 0) {
+
+            InstanceResult result;
+
+            // Wait until every instance exists, so that all start together
+            close(startPipe[1]); close(resultPipe[0]);
+            while (read(startPipe[0], &unused, 1) > 0);
+
+            // Results are far smaller than PIPE_BUF, so each write is atomic
+            result = runInstance(depth, megabytes);
+            _exit(write(resultPipe[1], &result, sizeof(result)) != sizeof(result));
+        }
+    }
+
+    // Closing our end of the start pipe releases all of the instances
+    close(startPipe[0]); close(startPipe[1]); close(resultPipe[1]);
+    start = getRealTime();
+
+    while (finished < started && read(resultPipe[0], &results[finished], sizeof(InstanceResult)) == sizeof(InstanceResult))
+        finished++;
+
+    // Wall clock time from the release until the last instance finished
+    *elapsed = MAX(1.0, getRealTime() - start);
+
+    close(resultPipe[0]);
+    while (wait(NULL) > 0);
+
+    return started == count && finished == count;
+}
+
+void runThroughputBenchmark(int depth, int instances, int megabytes) {
+
+    InstanceResult results[THROUGHPUT_MAX_INSTANCES];
+    double single = 0.0;
+
+    depth     = depth == 0 ? 13 : depth;
+    instances = MAX(1, MIN(THROUGHPUT_MAX_INSTANCES, instances));
+
+    printf("%9s  %13s  %33s  %10s\n", "Instances", "Aggregate NPS",
+        "Per Instance NPS min / mean / max", "Efficiency");
+
+    // Double the number of instances each step, finishing on the maximum
+    for (int count = 1; ; count = MIN(instances, 2 * count)) {
+
+        double elapsed, mean = 0.0, lowest = 0.0, highest = 0.0;
+        uint64_t nodes = 0ull;
+
+        ABORT_SIGNAL = 0;
+
+        if (!runInstances(results, count, depth, megabytes, &elapsed)) {
+            printf("Unable to run %d instances\n", count);
+            return;
+        }
+
+        for (int i = 0; i < count; i++) {
+            double nps = results[i].nodes / (results[i].elapsed / 1000.0);
+            lowest  = i == 0 ? nps : MIN(lowest, nps);
+            highest = i == 0 ? nps : MAX(highest, nps);
+            mean   += nps / count;
+            nodes  += results[i].nodes;
+        }
+
+        if (count == 1) single = mean;
+
+        // The aggregate is every node searched over the wall clock time, so
+        // that instances finishing early do not inflate it. Efficiency
+        // compares the mean instance against one running alone
+        printf("%9d  %13d  %9d / %9d / %9d  %9.1f%%\n",
+            count, (int)(nodes / (elapsed / 1000.0)), (int)lowest, (int)mean, (int)highest,
+            100.0 * mean / single);
+
+        if (count == instances) break;
+    }
+}
+
+#else
+
+void runThroughputBenchmark(int depth, int instances, int megabytes) {
+    (void) depth; (void) instances; (void) megabytes;
+    printf("Throughput benchmarks are not supported on this platform\n");
+}
+
+#endif
@@ -20,10 +20,14 @@
     #include <windows.h>
 #else
     #include <sys/time.h>
+    #include <time.h>
+    #include <unistd.h>
 #endif
 
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "governor.h"
 #include "search.h"
 #include "thread.h"
 #include "time.h"
@@ -49,6 +53,27 @@ double getRealTime(){
 #endif
 }
 
+uint64_t getPreciseTime(){
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart * (1e9 / frequency.QuadPart));
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void sleepMilliseconds(int ms){
+#if defined(_WIN32) || defined(_WIN64)
+    Sleep(ms);
+#else
+    usleep(1000 * ms);
+#endif
+}
+
 double elapsedTime(SearchInfo* info){
     return getRealTime() - info->startTime;
 }
@@ -148,8 +173,16 @@ int terminateSearchEarly(Thread *thread) {
 
     const Limits *limits = thread->limits;
 
+    if ((thread->nodes & 1023) != 1023)
+        return 0;
+
+    // Throttle the Thread when the CPU governor is enabled
+    governThread(thread);
+
+    // Record the time of the check for the Thread health monitor
+    thread->lastcheck = getRealTime();
+
     return  thread->depth > 1
-        && (thread->nodes & 1023) == 1023
         && (limits->limitedBySelf || limits->limitedByTime)
-        &&  elapsedTime(thread->info) >= thread->info->maxUsage;
-}
\ No newline at end of file
+        &&  thread->lastcheck - thread->info->startTime >= thread->info->maxUsage;
+}
@@ -19,9 +19,13 @@
 #ifndef _MY_TIME_H
 #define _MY_TIME_H
 
+#include <stdint.h>
+
 #include "types.h"
 
 double getRealTime();
+uint64_t getPreciseTime();
+void sleepMilliseconds(int ms);
 double elapsedTime(SearchInfo* info);
 void initTimeManagment(SearchInfo* info, Limits* limits);
 void updateTimeManagment(SearchInfo* info, Limits* limits, int depth, int value);
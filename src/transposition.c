@@ -20,14 +20,31 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
+#include <inttypes.h>
 #include <string.h>
 
 #include "move.h"
 #include "types.h"
 #include "transposition.h"
+#include "writer.h"
 
 TTable Table; // Global Transposition Table
 
+FILE *TTTrace; // Trace of every probe and store, when enabled
+
+static void traceTT(int type, uint64_t hash, int depth, int bound) {
+
+    TTTraceRecord record = {0};
+
+    record.hash       = hash;
+    record.depth      = (int8_t)depth;
+    record.bound      = (uint8_t)bound;
+    record.generation = Table.generation;
+    record.type       = (uint8_t)type;
+
+    fwrite(&record, sizeof(TTTraceRecord), 1, TTTrace);
+}
+
 void initTT(uint64_t megabytes) {
 
     // Free up memory if we already allocated
@@ -59,9 +76,43 @@ void updateTT() {
 }
 
 void clearTT() {
+    if (TTTrace != NULL) traceTT(TTTRACE_CLEAR, 0ull, 0, BOUND_NONE);
     memset(Table.buckets, 0, sizeof(TTBucket) * (Table.hashMask + 1u));
 }
 
+int saveTT(FILE *fout) {
+
+    return fwrite(&Table.hashMask, sizeof(uint64_t), 1, fout) == 1
+        && fwrite(&Table.generation, sizeof(uint8_t), 1, fout) == 1
+        && fwrite(Table.buckets, sizeof(TTBucket), Table.hashMask + 1, fout) == Table.hashMask + 1;
+}
+
+int loadTT(FILE *fin) {
+
+    uint64_t hashMask;
+
+    if (fread(&hashMask, sizeof(uint64_t), 1, fin) != 1)
+        return 0;
+
+    // Only accept a table of the size given by the Hash option, so that
+    // nothing is ever allocated based on a size read from the file
+    if (hashMask != Table.hashMask) {
+        if (!(hashMask & (hashMask + 1)) && hashMask < (1ull << 40))
+            writerPrintf("info string suspended table needs Hash %"PRIu64"\n",
+                ((hashMask + 1) * sizeof(TTBucket)) >> 20);
+        return 0;
+    }
+
+    // Leave an empty table behind if the file is truncated
+    if (   fread(&Table.generation, sizeof(uint8_t), 1, fin) != 1
+        || fread(Table.buckets, sizeof(TTBucket), hashMask + 1, fin) != hashMask + 1) {
+        clearTT();
+        return 0;
+    }
+
+    return 1;
+}
+
 int hashfullTT() {
 
     int used = 0;
@@ -75,11 +126,17 @@ int hashfullTT() {
     return used / 3;
 }
 
+void prefetchTTEntry(uint64_t hash) {
+    __builtin_prefetch(&Table.buckets[hash & Table.hashMask]);
+}
+
 int getTTEntry(uint64_t hash, uint16_t *move, int *value, int *eval, int *depth, int *bound) {
 
     const uint16_t hash16 = hash >> 48;
     TTEntry *slots = &Table.buckets[hash & Table.hashMask].slots[0];
 
+    if (TTTrace != NULL) traceTT(TTTRACE_PROBE, hash, 0, BOUND_NONE);
+
     // Search for a matching hash signature
     for (int i = 0; i < 3; i++) {
 
@@ -111,6 +168,8 @@ void storeTTEntry(uint64_t hash, uint16_t move, int value, int eval, int depth,
     const uint16_t hash16 = hash >> 48;
     TTEntry *replace = NULL, *slots = &Table.buckets[hash & Table.hashMask].slots[0];
 
+    if (TTTrace != NULL) traceTT(TTTRACE_STORE, hash, depth, bound);
+
     for (int i = 0; i < 3; i++) {
 
         // Found a matching hash or an unused entry
@@ -147,14 +206,39 @@ void storeTTEntry(uint64_t hash, uint16_t move, int value, int eval, int depth,
     replace->hash16     = (uint16_t)hash16;
 }
 
+void startTTTrace(char *path) {
+
+    char header[16] = "Ethereal TT";
+    uint32_t megabytes = (uint32_t)(((Table.hashMask + 1u) * sizeof(TTBucket)) >> 20);
+
+    if ((TTTrace = fopen(path, "wb")) == NULL) {
+        printf("Unable to open TT trace file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    setvbuf(TTTrace, NULL, _IOFBF, 1 << 20);
+
+    // The header records the size of the Table which produced the trace
+    memcpy(header + 12, &megabytes, sizeof(uint32_t));
+    fwrite(header, 1, sizeof(header), TTTrace);
+}
+
+void stopTTTrace() {
+
+    if (TTTrace == NULL) return;
+
+    fclose(TTTrace);
+    TTTrace = NULL;
+}
+
 PawnKingEntry* getPawnKingEntry(PawnKingTable *pktable, uint64_t pkhash) {
-    PawnKingEntry *pkentry = &pktable->entries[pkhash >> 48];
-    return pkentry->pkhash == pkhash ? pkentry : NULL;
+    PawnKingEntry *pkentry = &pktable->entries[pkhash >> (64 - PK_TABLE_BITS)];
+    return pkentry->pkhash == (PawnKingKey)pkhash ? pkentry : NULL;
 }
 
 void storePawnKingEntry(PawnKingTable *pktable, uint64_t pkhash, uint64_t passed, int eval) {
-    PawnKingEntry *pkentry = &pktable->entries[pkhash >> 48];
-    pkentry->pkhash = pkhash;
+    PawnKingEntry *pkentry = &pktable->entries[pkhash >> (64 - PK_TABLE_BITS)];
+    pkentry->pkhash = (PawnKingKey)pkhash;
     pkentry->passed = passed;
     pkentry->eval   = eval;
 }
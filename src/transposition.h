@@ -20,6 +20,7 @@
 #define _TRANSPOSITON_H
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include "types.h"
 
@@ -50,23 +51,53 @@ struct TTable {
     uint64_t hashMask;
 };
 
+enum {
+    TTTRACE_PROBE = 0,
+    TTTRACE_STORE = 1,
+    TTTRACE_CLEAR = 2,
+};
+
+struct TTTraceRecord {
+    uint64_t hash;
+    int8_t depth;
+    uint8_t bound;
+    uint8_t generation;
+    uint8_t type;
+    uint32_t padding;
+};
+
+#ifdef COMPACT_TABLES
+enum { PK_TABLE_BITS = 14 };
+typedef uint32_t PawnKingKey; // Upper bits are implied by the index
+#else
+enum { PK_TABLE_BITS = 16 };
+typedef uint64_t PawnKingKey;
+#endif
+
 struct PawnKingEntry {
-    uint64_t pkhash;
     uint64_t passed;
+    PawnKingKey pkhash;
     int eval;
 };
 
 struct PawnKingTable {
-    PawnKingEntry entries[0x10000];
+    PawnKingEntry entries[1 << PK_TABLE_BITS];
 };
 
 void initTT(uint64_t megabytes);
 void updateTT();
 void clearTT();
 int hashfullTT();
+void prefetchTTEntry(uint64_t hash);
 int getTTEntry(uint64_t hash, uint16_t *move, int *value, int *eval, int *depth, int *bound);
 void storeTTEntry(uint64_t hash, uint16_t move, int value, int eval, int depth, int bound);
 
+int saveTT(FILE *fout);
+int loadTT(FILE *fin);
+
+void startTTTrace(char *path);
+void stopTTTrace();
+
 PawnKingEntry* getPawnKingEntry(PawnKingTable *pktable, uint64_t pkhash);
 void storePawnKingEntry(PawnKingTable *pktable, uint64_t pkhash, uint64_t passed, int eval);
 
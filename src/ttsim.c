@@ -0,0 +1,221 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "transposition.h"
+#include "ttsim.h"
+#include "types.h"
+
+// Replay a trace of Table probes and stores, written by "bench" when given a
+// trace file, against a set of replacement policies and bucket geometries.
+// Slots keep the full hash, so hits are exact rather than 16-bit matches
+
+static int ageOf(SimSlot *slot, TTTraceRecord *store) {
+    return (259 + store->generation - slot->generation) & 0xFC;
+}
+
+static int findReusable(SimSlot *bucket, int ways, TTTraceRecord *store) {
+
+    // Every policy reuses the slot for this position, or an unused slot
+    for (int i = 0; i < ways; i++)
+        if (bucket[i].hash == store->hash || (bucket[i].generation & 0x3) == 0)
+            return i;
+
+    return -1;
+}
+
+static int keepExisting(SimSlot *slot, TTTraceRecord *store) {
+
+    // Don't overwrite an entry from the same position, unless we have
+    // an exact bound or depth that is nearly as good as the old one
+    return store->bound != BOUND_EXACT
+        && slot->hash == store->hash
+        && store->depth < slot->depth - 3;
+}
+
+static int selectEthereal(SimSlot *bucket, int ways, TTTraceRecord *store) {
+
+    int replace = findReusable(bucket, ways, store);
+
+    // Replace using MAX(x1, x2), where xN = depth - 8 * age difference
+    if (replace == -1) {
+        replace = 0;
+        for (int i = 1; i < ways; i++)
+            if (   bucket[replace].depth - ageOf(&bucket[replace], store) * 2
+                >= bucket[i].depth - ageOf(&bucket[i], store) * 2)
+                replace = i;
+    }
+
+    return keepExisting(&bucket[replace], store) ? -1 : replace;
+}
+
+static int selectShallowest(SimSlot *bucket, int ways, TTTraceRecord *store) {
+
+    int replace = findReusable(bucket, ways, store);
+
+    // Replace the shallowest entry, ignoring the age of each entry
+    if (replace == -1) {
+        replace = 0;
+        for (int i = 1; i < ways; i++)
+            if (bucket[i].depth <= bucket[replace].depth)
+                replace = i;
+    }
+
+    return keepExisting(&bucket[replace], store) ? -1 : replace;
+}
+
+static int selectOldest(SimSlot *bucket, int ways, TTTraceRecord *store) {
+
+    int replace = findReusable(bucket, ways, store);
+
+    // Replace the oldest entry, using depth to break ties
+    if (replace == -1) {
+        replace = 0;
+        for (int i = 1; i < ways; i++)
+            if (    ageOf(&bucket[i], store) > ageOf(&bucket[replace], store)
+                || (ageOf(&bucket[i], store) == ageOf(&bucket[replace], store)
+                    && bucket[i].depth <= bucket[replace].depth))
+                replace = i;
+    }
+
+    return keepExisting(&bucket[replace], store) ? -1 : replace;
+}
+
+static int selectAlways(SimSlot *bucket, int ways, TTTraceRecord *store) {
+
+    int replace = findReusable(bucket, ways, store);
+
+    // Always store, replacing the final slot when the bucket is full
+    return replace == -1 ? ways - 1 : replace;
+}
+
+void runTTSimulator(char *path) {
+
+    char header[16];
+    uint32_t megabytes;
+    FILE *fin = fopen(path, "rb");
+
+    static SimPolicy policies[] = {
+        { "Ethereal",   selectEthereal   },
+        { "Shallowest", selectShallowest },
+        { "Oldest",     selectOldest     },
+        { "Always",     selectAlways     },
+    };
+
+    static const int geometries[] = { 1, 2, 3, 4, 8 };
+
+    if (   fin == NULL
+        || fread(header, 1, sizeof(header), fin) != sizeof(header)
+        || memcmp(header, "Ethereal TT", 12)) {
+        printf("Unable to read TT trace file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    // Keep the number of entries of the traced Table for each geometry
+    memcpy(&megabytes, header + 12, sizeof(uint32_t));
+    uint64_t entries = ((uint64_t)megabytes << 20) / sizeof(TTBucket) * 3;
+
+    printf("Trace from a %"PRIu32"MB Table, deep entries have depth >= %d\n\n",
+           megabytes, SimDeepDepth);
+    printf("Policy      Ways  Buckets     Probes      Hit Rate  Stores      Skipped   Deep Survival\n");
+
+    for (int i = 0; i < (int)(sizeof(policies) / sizeof(SimPolicy)); i++) {
+        for (int j = 0; j < (int)(sizeof(geometries) / sizeof(int)); j++) {
+
+            SimStats stats;
+            uint64_t nbuckets = 1;
+
+            while (nbuckets * 2 * geometries[j] <= entries)
+                nbuckets *= 2;
+
+            fseek(fin, sizeof(header), SEEK_SET);
+            simulateTT(fin, &policies[i], geometries[j], nbuckets, &stats);
+
+            printf("%-11s %-5d %-11"PRIu64" %-11"PRIu64" %7.3f%%  %-11"PRIu64" %-9"PRIu64" %7.3f%%\n",
+                   policies[i].name, geometries[j], nbuckets, stats.probes,
+                   100.0 * stats.hits / (stats.probes ? stats.probes : 1),
+                   stats.stores, stats.skipped,
+                   100.0 - 100.0 * stats.deepEvicted / (stats.deepStores ? stats.deepStores : 1));
+        }
+    }
+
+    fclose(fin);
+}
+
+void simulateTT(FILE *fin, SimPolicy *policy, int ways, uint64_t nbuckets, SimStats *stats) {
+
+    TTTraceRecord records[4096];
+    SimSlot *slots = calloc(nbuckets * ways, sizeof(SimSlot));
+    size_t count;
+
+    memset(stats, 0, sizeof(SimStats));
+
+    while ((count = fread(records, sizeof(TTTraceRecord), 4096, fin)) > 0) {
+
+        for (size_t i = 0; i < count; i++) {
+
+            TTTraceRecord *record = &records[i];
+            SimSlot *bucket = &slots[(record->hash & (nbuckets - 1)) * ways];
+            int slot;
+
+            if (record->type == TTTRACE_CLEAR)
+                memset(slots, 0, sizeof(SimSlot) * nbuckets * ways);
+
+            else if (record->type == TTTRACE_PROBE) {
+
+                stats->probes++;
+
+                // A hit refreshes the age of the entry, keeping the bound
+                for (slot = 0; slot < ways; slot++) {
+                    if (bucket[slot].hash == record->hash && (bucket[slot].generation & 0x3)) {
+                        bucket[slot].generation = record->generation | (bucket[slot].generation & 0x3);
+                        stats->hits++; break;
+                    }
+                }
+            }
+
+            else if (record->type == TTTRACE_STORE) {
+
+                if ((slot = policy->select(bucket, ways, record)) == -1) {
+                    stats->skipped++;
+                    continue;
+                }
+
+                // Count deep entries of other positions that have been lost
+                if (   bucket[slot].hash != record->hash
+                    && (bucket[slot].generation & 0x3)
+                    &&  bucket[slot].depth >= SimDeepDepth)
+                    stats->deepEvicted++;
+
+                stats->stores++;
+                stats->deepStores += record->depth >= SimDeepDepth;
+
+                bucket[slot].hash       = record->hash;
+                bucket[slot].depth      = record->depth;
+                bucket[slot].generation = record->generation | record->bound;
+            }
+        }
+    }
+
+    free(slots);
+}
@@ -0,0 +1,45 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+struct SimSlot {
+    uint64_t hash;
+    int8_t depth;
+    uint8_t generation;
+};
+
+struct SimPolicy {
+    char *name;
+    int (*select)(SimSlot *bucket, int ways, TTTraceRecord *store);
+};
+
+struct SimStats {
+    uint64_t probes, hits;
+    uint64_t stores, skipped;
+    uint64_t deepStores, deepEvicted;
+};
+
+void runTTSimulator(char *path);
+void simulateTT(FILE *fin, SimPolicy *policy, int ways, uint64_t nbuckets, SimStats *stats);
+
+static const int SimDeepDepth = 10;
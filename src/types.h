@@ -93,6 +93,8 @@ typedef struct Magic Magic;
 typedef struct Board Board;
 typedef struct Undo Undo;
 typedef struct EvalTrace EvalTrace;
+typedef struct TraceRecord TraceRecord;
+typedef struct SparseTrace SparseTrace;
 typedef struct EvalInfo EvalInfo;
 typedef struct MovePicker MovePicker;
 typedef struct SearchInfo SearchInfo;
@@ -100,18 +102,41 @@ typedef struct PVariation PVariation;
 typedef struct TexelTuple TexelTuple;
 typedef struct TexelEntry TexelEntry;
 typedef struct Thread Thread;
+typedef struct SearchStack SearchStack;
 typedef struct TTEntry TTEntry;
 typedef struct TTBucket TTBucket;
 typedef struct TTable TTable;
+typedef struct TTTraceRecord TTTraceRecord;
+typedef struct SimSlot SimSlot;
+typedef struct SimPolicy SimPolicy;
+typedef struct SimStats SimStats;
 typedef struct PawnKingEntry PawnKingEntry;
 typedef struct PawnKingTable PawnKingTable;
 typedef struct Limits Limits;
 typedef struct ThreadsGo ThreadsGo;
+typedef struct Monitor Monitor;
+typedef struct WeightTerm WeightTerm;
+typedef struct ExperienceEntry ExperienceEntry;
+typedef struct SuspendHeader SuspendHeader;
+typedef struct BookEntry BookEntry;
+typedef struct BookBuilder BookBuilder;
+typedef struct ProfileStats ProfileStats;
+typedef struct AttackCache AttackCache;
+typedef struct SearchFiber SearchFiber;
+typedef struct WriterSlot WriterSlot;
+typedef struct EngineTables EngineTables;
 
 // Renamings, currently for move ordering
 
-typedef uint16_t KillerTable[MAX_PLY+1][2];
 typedef uint16_t CounterMoveTable[COLOUR_NB][PIECE_NB][SQUARE_NB];
-typedef int16_t HistoryTable[COLOUR_NB][SQUARE_NB][SQUARE_NB];
-typedef int16_t CMHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
-typedef int16_t FUHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
+#ifdef COMPACT_TABLES
+typedef int8_t HistoryEntry; // Log-scaled, see history.c
+#else
+typedef int16_t HistoryEntry;
+#endif
+
+typedef HistoryEntry HistoryTable[COLOUR_NB][SQUARE_NB][SQUARE_NB];
+typedef HistoryEntry ContinuationTable[PIECE_NB][SQUARE_NB];
+typedef HistoryEntry CMHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
+typedef HistoryEntry FUHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
+typedef int16_t GainHistoryTable[COLOUR_NB][PIECE_NB][SQUARE_NB][SQUARE_NB];
@@ -23,22 +23,37 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "analysis.h"
 #include "attacks.h"
 #include "board.h"
+#include "book.h"
+#include "evalprofile.h"
 #include "evaluate.h"
+#include "experience.h"
 #include "fathom/tbprobe.h"
+#include "governor.h"
 #include "history.h"
+#include "interleave.h"
 #include "masks.h"
+#include "monitor.h"
 #include "move.h"
 #include "movegen.h"
+#include "numa.h"
 #include "psqt.h"
+#include "resources.h"
 #include "search.h"
+#include "suspend.h"
+#include "syzygy.h"
 #include "texel.h"
 #include "thread.h"
+#include "throughput.h"
 #include "time.h"
 #include "transposition.h"
+#include "ttsim.h"
 #include "types.h"
 #include "uci.h"
+#include "weights.h"
+#include "writer.h"
 #include "zobrist.h"
 
 
@@ -46,12 +61,22 @@ extern int MoveOverhead; // Defined by Time.c
 
 extern unsigned TB_PROBE_DEPTH; // Defined by Syzygy.c
 
+extern unsigned TB_PROBE_BUDGET; // Defined by Syzygy.c
+
 extern volatile int ABORT_SIGNAL; // For killing active search
 
 extern volatile int IS_PONDERING; // For swapping out of PONDER
 
+extern volatile int IS_WARMING; // For cancelling a warming search
+
+int WarmSearch; // Search the expected reply after reporting a bestmove
+
+static int WarmCancelled, GoFinished; // Guarded by the WARMLOCK
+
 pthread_mutex_t READYLOCK = PTHREAD_MUTEX_INITIALIZER;
 
+pthread_mutex_t WARMLOCK = PTHREAD_MUTEX_INITIALIZER;
+
 
 int main(int argc, char **argv) {
 
@@ -59,9 +84,15 @@ int main(int argc, char **argv) {
     char str[8192], *ptr;
     ThreadsGo threadsgo;
     pthread_t pthreadsgo;
+    int searching = 0;
+
+    // Threads and Hash may be sized based on the limits of the container
+    int autoThreads = argc > 3 && uciIsAutoValue(argv[3]);
+    int autoHash    = argc > 4 && uciIsAutoValue(argv[4]);
 
-    int nthreads = argc > 3 ? atoi(argv[3]) : 1;
-    int megabytes = argc > 4 ? atoi(argv[4]) : 16;
+    int nthreads  = autoThreads ? autoThreadCount() : argc > 3 ? atoi(argv[3]) : 1;
+    int megabytes = autoHash ? autoHashMegabytes(nthreads) : argc > 4 ? atoi(argv[4]) : 16;
+    int count;
 
     // Initialize the core components of Ethereal
     initAttacks();
@@ -69,6 +100,8 @@ int main(int argc, char **argv) {
     initMasks();
     initZobrist();
     initSearch();
+    initHistory();
+    initNuma();
 
     // Default to 16MB TT
     initTT(megabytes);
@@ -85,105 +118,288 @@ int main(int argc, char **argv) {
     #endif
 
     if (argc > 1 && stringEquals(argv[1], "bench")) {
+        if (argc > 5) startTTTrace(argv[5]);
         runBenchmark(threads, argc > 2 ? atoi(argv[2]) : 0);
+        stopTTTrace();
+        return 0;
+    }
+
+    if (argc > 1 && stringEquals(argv[1], "interleave")) {
+        runInterleavedBenchmark(argc > 2 ? atoi(argv[2]) : 0, nthreads);
+        return 0;
+    }
+
+    if (argc > 1 && stringEquals(argv[1], "throughput")) {
+        runThroughputBenchmark(argc > 2 ? atoi(argv[2]) : 0, nthreads, megabytes);
+        return 0;
+    }
+
+    if (argc > 2 && stringEquals(argv[1], "ttsim")) {
+        runTTSimulator(argv[2]);
         return 0;
     }
 
+    if (argc > 2 && stringEquals(argv[1], "evalprofile")) {
+        runEvalProfile(argv[2]);
+        return 0;
+    }
+
+    // Output for the interface is written by its own thread from here on
+    startWriter();
+
     while (1){
 
         getInput(str);
 
         if (stringEquals(str, "uci")){
-            printf("id name Ethereal " ETHEREAL_VERSION "\n");
-            printf("id author Andrew Grant & Laldon\n");
-            printf("option name Hash type spin default 16 min 1 max 65536\n");
-            printf("option name Threads type spin default 1 min 1 max 2048\n");
-            printf("option name MoveOverhead type spin default 100 min 0 max 10000\n");
-            printf("option name SyzygyPath type string default <empty>\n");
-            printf("option name SyzygyProbeDepth type spin default 0 min 0 max 127\n");
-            printf("option name Ponder type check default false\n");
-            printf("uciok\n");
-            fflush(stdout);
+            writerPrintf("id name Ethereal " ETHEREAL_VERSION "\n");
+            writerPrintf("id author Andrew Grant & Laldon\n");
+            writerPrintf("option name Hash type spin default 16 min 0 max 65536\n");
+            writerPrintf("option name Threads type spin default 1 min 0 max 2048\n");
+            writerPrintf("option name MoveOverhead type spin default 100 min 0 max 10000\n");
+            writerPrintf("option name SyzygyPath type string default <empty>\n");
+            writerPrintf("option name SyzygyProbeDepth type spin default 0 min 0 max 127\n");
+            writerPrintf("option name SyzygyProbeBudget type spin default 0 min 0 max 100\n");
+            writerPrintf("option name MonitorInterval type spin default 0 min 0 max 60000\n");
+            writerPrintf("option name CPULimit type spin default 100 min 1 max 100\n");
+            writerPrintf("option name LowPriority type check default false\n");
+            writerPrintf("option name NumaReplicate type check default false\n");
+            writerPrintf("option name WeightsFile type string default <empty>\n");
+            writerPrintf("option name ExperienceFile type string default <empty>\n");
+            writerPrintf("option name ExperienceDepth type spin default 16 min 1 max 127\n");
+            writerPrintf("option name WarmSearch type check default false\n");
+            writerPrintf("option name Ponder type check default false\n");
+            writerPrintf("uciok\n");
         }
 
         else if (stringEquals(str, "isready")){
+            tablebasesWaitForLoad();
             pthread_mutex_lock(&READYLOCK);
-            printf("readyok\n");
-            fflush(stdout);
+            writerPrintf("readyok\n");
             pthread_mutex_unlock(&READYLOCK);
         }
 
         else if (stringStartsWith(str, "setoption")){
 
+            uciStopWarming(pthreadsgo, &searching);
+
             if (stringStartsWith(str, "setoption name Hash value ")){
-                megabytes = atoi(str + strlen("setoption name Hash value "));
+                ptr = str + strlen("setoption name Hash value ");
+                autoHash = uciIsAutoValue(ptr);
+                megabytes = autoHash ? autoHashMegabytes(nthreads) : atoi(ptr);
                 initTT(megabytes);
-                printf("info string set Hash to %dMB\n", megabytes);
+                writerPrintf("info string set Hash to %dMB\n", megabytes);
             }
 
             if (stringStartsWith(str, "setoption name Threads value ")){
                 free(threads);
-                nthreads = atoi(str + strlen("setoption name Threads value "));
+                ptr = str + strlen("setoption name Threads value ");
+                autoThreads = uciIsAutoValue(ptr);
+                nthreads = autoThreads ? autoThreadCount() : atoi(ptr);
                 threads = createThreadPool(nthreads);
-                printf("info string set Threads to %d\n", nthreads);
+                writerPrintf("info string set Threads to %d\n", nthreads);
+
+                // An automatic Hash size depends on the size of the Thread pool
+                if (autoHash) {
+                    megabytes = autoHashMegabytes(nthreads);
+                    initTT(megabytes);
+                    writerPrintf("info string set Hash to %dMB\n", megabytes);
+                }
             }
 
             if (stringStartsWith(str, "setoption name MoveOverhead value ")){
                 MoveOverhead = atoi(str + strlen("setoption name MoveOverhead value "));
-                printf("info string set MoveOverhead to %d\n", MoveOverhead);
+                writerPrintf("info string set MoveOverhead to %d\n", MoveOverhead);
             }
 
             if (stringStartsWith(str, "setoption name SyzygyPath value ")){
                 ptr = str + strlen("setoption name SyzygyPath value ");
-                tb_init(ptr); printf("info string set SyzygyPath to %s\n", ptr);
+                tablebasesLoad(ptr);
             }
 
             if (stringStartsWith(str, "setoption name SyzygyProbeDepth value ")){
                 TB_PROBE_DEPTH = atoi(str + strlen("setoption name SyzygyProbeDepth value "));
-                printf("info string set SyzygyProbeDepth to %u\n", TB_PROBE_DEPTH);
+                writerPrintf("info string set SyzygyProbeDepth to %u\n", TB_PROBE_DEPTH);
+            }
+
+            if (stringStartsWith(str, "setoption name SyzygyProbeBudget value ")){
+                TB_PROBE_BUDGET = atoi(str + strlen("setoption name SyzygyProbeBudget value "));
+                writerPrintf("info string set SyzygyProbeBudget to %u\n", TB_PROBE_BUDGET);
+            }
+
+            if (stringStartsWith(str, "setoption name MonitorInterval value ")){
+                MONITOR_INTERVAL = atoi(str + strlen("setoption name MonitorInterval value "));
+                writerPrintf("info string set MonitorInterval to %d\n", MONITOR_INTERVAL);
+            }
+
+            if (stringStartsWith(str, "setoption name CPULimit value ")){
+                CPU_LIMIT = MAX(1, MIN(100, atoi(str + strlen("setoption name CPULimit value "))));
+                writerPrintf("info string set CPULimit to %d%%\n", CPU_LIMIT);
+            }
+
+            if (stringStartsWith(str, "setoption name LowPriority value ")){
+                LOW_PRIORITY = stringEquals(str, "setoption name LowPriority value true");
+                writerPrintf("info string set LowPriority to %s\n", LOW_PRIORITY ? "true" : "false");
+            }
+
+            if (stringStartsWith(str, "setoption name NumaReplicate value ")){
+                NUMA_REPLICATE = stringEquals(str, "setoption name NumaReplicate value true");
+                writerPrintf("info string set NumaReplicate to %s\n", NUMA_REPLICATE ? "true" : "false");
+            }
+
+            if (stringStartsWith(str, "setoption name ExperienceFile value ")){
+                ptr = str + strlen("setoption name ExperienceFile value ");
+                if (stringEquals(ptr, "<empty>")) closeExperience();
+                else openExperience(ptr);
+                writerPrintf("info string set ExperienceFile to %s\n", ptr);
+            }
+
+            if (stringStartsWith(str, "setoption name ExperienceDepth value ")){
+                EXPERIENCE_DEPTH = atoi(str + strlen("setoption name ExperienceDepth value "));
+                writerPrintf("info string set ExperienceDepth to %d\n", EXPERIENCE_DEPTH);
+            }
+
+            if (stringStartsWith(str, "setoption name WarmSearch value ")){
+                WarmSearch = stringEquals(str, "setoption name WarmSearch value true");
+                writerPrintf("info string set WarmSearch to %s\n", WarmSearch ? "true" : "false");
+            }
+
+            if (stringStartsWith(str, "setoption name WeightsFile value ")){
+                ptr = str + strlen("setoption name WeightsFile value ");
+
+                if (stringEquals(ptr, "<empty>")) {
+                    restoreWeights();
+                    writerPrintf("info string set WeightsFile to <empty>\n");
+                }
+
+                else if ((count = loadWeights(ptr)) > 0)
+                    writerPrintf("info string set WeightsFile to %s (%d terms)\n", ptr, count);
+
+                // Cached evaluations were computed with the old weights,
+                // as were the copies of the PSQT for each Numa node
+                resetThreadPool(threads);
+                resetNumaTables();
+                clearTT();
             }
 
-            fflush(stdout);
         }
 
         else if (stringEquals(str, "ucinewgame")){
+            uciStopWarming(pthreadsgo, &searching);
             resetThreadPool(threads);
             clearTT();
         }
 
-        else if (stringStartsWith(str, "position"))
+        else if (stringStartsWith(str, "position")){
+            uciStopWarming(pthreadsgo, &searching);
             uciPosition(str, &board);
+            if ((count = preloadExperience(&board)) > 0)
+                writerPrintf("info string loaded %d experience entries\n", count);
+        }
 
         else if (stringStartsWith(str, "go")){
-            strncpy(threadsgo.str, str, 512);
+            uciStopWarming(pthreadsgo, &searching);
+            tablebasesWaitForLoad();
+            WarmCancelled = GoFinished = 0;
+            strncpy(threadsgo.str, str, sizeof(threadsgo.str));
             threadsgo.threads = threads;
             threadsgo.board = &board;
             pthread_create(&pthreadsgo, NULL, &uciGo, &threadsgo);
+            searching = 1;
         }
 
         else if (stringEquals(str, "ponderhit"))
             IS_PONDERING = 0;
 
         else if (stringEquals(str, "stop")){
+            stopGameAnalysis();
+            pthread_mutex_lock(&WARMLOCK);
+            WarmCancelled = 1;
+            ABORT_SIGNAL = 1;
+            IS_PONDERING = 0;
+            pthread_mutex_unlock(&WARMLOCK);
+            if (searching) pthread_join(pthreadsgo, NULL);
+            searching = 0;
+        }
+
+        else if (stringStartsWith(str, "suspend ")){
+            requestSuspend(str + strlen("suspend "));
+            pthread_mutex_lock(&WARMLOCK);
+            WarmCancelled = 1;
             ABORT_SIGNAL = 1;
             IS_PONDERING = 0;
-            pthread_join(pthreadsgo, NULL);
+            pthread_mutex_unlock(&WARMLOCK);
+            if (searching) pthread_join(pthreadsgo, NULL);
+            searching = 0;
+
+            // Still pending if there was no search to suspend
+            suspendIfRequested(threads, &board, NULL);
+        }
+
+        else if (stringStartsWith(str, "resume ")){
+            uciStopWarming(pthreadsgo, &searching);
+            tablebasesWaitForLoad();
+            if (searching)
+                writerPrintf("info string stop the search before resuming\n");
+
+            // Continue the search as an infinite analysis
+            else if (resumeSearch(str + strlen("resume "), threads, &board)){
+                WarmCancelled = GoFinished = 0;
+                strncpy(threadsgo.str, "go infinite", sizeof(threadsgo.str));
+                threadsgo.threads = threads;
+                threadsgo.board = &board;
+                pthread_create(&pthreadsgo, NULL, &uciGo, &threadsgo);
+                searching = 1;
+            }
         }
 
-        else if (stringEquals(str, "quit"))
+        else if (stringStartsWith(str, "analyse")){
+            uciStopWarming(pthreadsgo, &searching);
+            tablebasesWaitForLoad();
+            if (searching)
+                writerPrintf("info string stop the search before analysing\n");
+
+            // Analyse on a thread of its own, as with go, so that it may be stopped
+            else {
+                resetGameAnalysis();
+                WarmCancelled = GoFinished = 0;
+                strncpy(threadsgo.str, str, sizeof(threadsgo.str));
+                threadsgo.threads = threads;
+                threadsgo.board = &board;
+                pthread_create(&pthreadsgo, NULL, &uciAnalyse, &threadsgo);
+                searching = 1;
+            }
+        }
+
+        else if (stringEquals(str, "quit")){
+            uciStopWarming(pthreadsgo, &searching);
+            tablebasesWaitForLoad();
             break;
+        }
 
         else if (stringStartsWith(str, "perft")){
-            printf("%"PRIu64"\n", perft(&board, atoi(str + strlen("perft "))));
-            fflush(stdout);
+            writerPrintf("%"PRIu64"\n", perft(&board, atoi(str + strlen("perft "))));
+        }
+
+        else if (stringStartsWith(str, "makebook ")){
+            runMakeBook(str);
+        }
+
+        else if (stringEquals(str, "footprint")){
+            printThreadFootprint(threads);
         }
 
         else if (stringStartsWith(str, "print")){
             printBoard(&board);
-            fflush(stdout);
         }
     }
 
+    // Finish writing any results still queued for the experience file
+    closeExperience();
+
+    // Write out anything still queued for the interface
+    stopWriter();
+
     return 0;
 }
 
@@ -264,25 +480,64 @@ void* uciGo(void* vthreadsgo){
     // UCI spec does not want reports until out of pondering
     while (IS_PONDERING);
 
-    // Report best move (we should always have one)
-    moveToString(bestMove, bestMoveStr);
-    printf("bestmove %s ", bestMoveStr);
+    // Decide on warming before the bestmove goes out, so that any command
+    // sent in response to it is able to find and cancel the warming search
+    pthread_mutex_lock(&WARMLOCK);
+    int warm = WarmSearch && ponderMove != NONE_MOVE && !WarmCancelled;
+    if (warm) IS_WARMING = 1, ABORT_SIGNAL = 0;
+    GoFinished = 1;
+    pthread_mutex_unlock(&WARMLOCK);
 
-    // Report ponder move if we have one
+    // Report best move (we should always have one), and the ponder move
+    // if we have one, as a single message so that nothing splits the line
+    moveToString(bestMove, bestMoveStr);
     if (ponderMove != NONE_MOVE) {
         moveToString(ponderMove, ponderMoveStr);
-        printf("ponder %s", ponderMoveStr);
-    }
-
-    // Make sure this all gets reported
-    printf("\n"); fflush(stdout);
+        writerPrintf("bestmove %s ponder %s\n", bestMoveStr, ponderMoveStr);
+    } else writerPrintf("bestmove %s \n", bestMoveStr);
 
     // Drop the ready lock, as we are prepared to handle a new search
     pthread_mutex_unlock(&READYLOCK);
 
+    // Fill the TT and history tables while waiting on the opponent
+    if (warm) warmSearch(threads, board, bestMove, ponderMove);
+    IS_WARMING = 0;
+
+    return NULL;
+}
+
+void* uciAnalyse(void* vthreadsgo){
+
+    // Not ready for another command until the analysis is finished
+    pthread_mutex_lock(&READYLOCK);
+
+    runGameAnalysis(((ThreadsGo*)vthreadsgo)->threads, ((ThreadsGo*)vthreadsgo)->str);
+
+    // Let the next command join us, as it would a finished go
+    pthread_mutex_lock(&WARMLOCK);
+    GoFinished = 1;
+    pthread_mutex_unlock(&WARMLOCK);
+
+    pthread_mutex_unlock(&READYLOCK);
+
     return NULL;
 }
 
+void uciStopWarming(pthread_t pthreadsgo, int *searching){
+
+    // Cancel the warming search, or prevent one from starting
+    pthread_mutex_lock(&WARMLOCK);
+    WarmCancelled = 1;
+    if (IS_WARMING) ABORT_SIGNAL = 1;
+    pthread_mutex_unlock(&WARMLOCK);
+
+    // A finished search may still be warming, so we must wait on it
+    if (*searching && GoFinished) {
+        pthread_join(pthreadsgo, NULL);
+        *searching = 0;
+    }
+}
+
 void uciPosition(char* str, Board* board){
 
     int size;
@@ -336,6 +591,9 @@ void uciPosition(char* str, Board* board){
 
 void uciReport(Thread* threads, int alpha, int beta, int value){
 
+    // Warming searches are not reported to the interface
+    if (IS_WARMING) return;
+
     PVariation* pv  = &threads[0].pv;
     int hashfull    = hashfullTT();
     int depth       = threads[0].depth;
@@ -359,35 +617,39 @@ void uciReport(Thread* threads, int alpha, int beta, int value){
     char* bound = value >=  beta ? " lowerbound "
                 : value <= alpha ? " upperbound " : " ";
 
-    // Main chunk of interface reporting
-    printf("info depth %d seldepth %d score %s %d%stime %d "
-           "nodes %"PRIu64" nps %d tbhits %"PRIu64" hashfull %d pv ",
-           depth, seldepth, type, score, bound, elapsed, nodes, nps, tbhits, hashfull);
-
-    // Iterate over the PV and print each move
+    // Build the PV first, so that the report is queued as a single line
+    char line[MAX_PLY * 6 + 1] = "", *end = line;
     for (int i = 0; i < pv->length; i++){
-        char moveStr[6];
-        moveToString(pv->line[i], moveStr);
-        printf("%s ", moveStr);
+        moveToString(pv->line[i], end);
+        end += strlen(end); *end++ = ' '; *end = '\0';
     }
 
-    puts("");
-    fflush(stdout);
+    // Main chunk of interface reporting. Dropped rather than waiting
+    // for room when the interface is reading our output too slowly
+    writerPrintfInfo("info depth %d seldepth %d score %s %d%stime %d "
+                     "nodes %"PRIu64" nps %d tbhits %"PRIu64" hashfull %d pv %s\n",
+                     depth, seldepth, type, score, bound, elapsed, nodes, nps, tbhits, hashfull, line);
 }
 
 void uciReportTBRoot(uint16_t move, unsigned wdl, unsigned dtz){
 
+    if (IS_WARMING) return;
+
     int score = wdl == TB_LOSS ? -MATE + MAX_PLY + dtz + 1
               : wdl == TB_WIN  ?  MATE - MAX_PLY - dtz - 1 : 0;
 
-    printf("info depth %d seldepth %d score cp %d time 0 "
-           "nodes 0 tbhits 1 nps 0 hashfull %d pv ",
-           MAX_PLY - 1, MAX_PLY - 1, score, 0);
-
     char moveStr[6];
     moveToString(move, moveStr);
-    puts(moveStr);
-    fflush(stdout);
+
+    writerPrintfInfo("info depth %d seldepth %d score cp %d time 0 "
+                     "nodes 0 tbhits 1 nps 0 hashfull %d pv %s\n",
+                     MAX_PLY - 1, MAX_PLY - 1, score, 0, moveStr);
+}
+
+int uciIsAutoValue(char* str){
+    return stringEquals(str, "0")
+        || stringEquals(str, "auto")
+        || stringEquals(str, "Auto");
 }
 
 int stringEquals(char* s1, char* s2){
@@ -406,8 +668,10 @@ void getInput(char* str){
 
     char* ptr;
 
-    if (fgets(str, 8192, stdin) == NULL)
+    if (fgets(str, 8192, stdin) == NULL) {
+        stopWriter();
         exit(EXIT_FAILURE);
+    }
 
     ptr = strchr(str, '\n');
     if (ptr != NULL) *ptr = '\0';
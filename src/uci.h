@@ -19,6 +19,8 @@
 #ifndef _UCI_H
 #define _UCI_H
 
+#include <pthread.h>
+
 #include "types.h"
 
 #define VERSION_ID "11.28"
@@ -45,17 +47,20 @@ struct Limits {
 };
 
 struct ThreadsGo {
-    char str[512];
+    char str[8192];
     Thread* threads;
     Board* board;
 };
 
 void getInput(char* str);
+int uciIsAutoValue(char* str);
 int stringEquals(char* s1, char* s2);
 int stringStartsWith(char* str, char* key);
 int stringContains(char* str, char* key);
 
 void* uciGo(void* vthreadgo);
+void* uciAnalyse(void* vthreadsgo);
+void uciStopWarming(pthread_t pthreadsgo, int *searching);
 void uciPosition(char* str, Board* board);
 void uciReport(Thread* threads, int alpha, int beta, int value);
 void uciReportTBRoot(uint16_t move, unsigned wdl, unsigned dtz);
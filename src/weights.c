@@ -0,0 +1,232 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evaluate.h"
+#include "psqt.h"
+#include "types.h"
+#include "weights.h"
+#include "writer.h"
+
+extern int PawnValue;
+extern int KnightValue;
+extern int BishopValue;
+extern int RookValue;
+extern int QueenValue;
+extern int KingValue;
+extern int PawnPSQT32[32];
+extern int KnightPSQT32[32];
+extern int BishopPSQT32[32];
+extern int RookPSQT32[32];
+extern int QueenPSQT32[32];
+extern int KingPSQT32[32];
+extern int PawnCandidatePasser[2][8];
+extern int PawnIsolated;
+extern int PawnStacked;
+extern int PawnBackwards[2];
+extern int PawnConnected32[32];
+extern int KnightOutpost[2];
+extern int KnightBehindPawn;
+extern int KnightMobility[9];
+extern int BishopPair;
+extern int BishopRammedPawns;
+extern int BishopOutpost[2];
+extern int BishopBehindPawn;
+extern int BishopMobility[14];
+extern int RookFile[2];
+extern int RookOnSeventh;
+extern int RookMobility[15];
+extern int QueenMobility[28];
+extern int KingDefenders[12];
+extern int KingShelter[2][8][8];
+extern int KingStorm[2][4][8];
+extern int PassedPawn[2][2][8];
+extern int PassedFriendlyDistance[8];
+extern int PassedEnemyDistance[8];
+extern int PassedSafePromotionPath;
+extern int ThreatWeakPawn;
+extern int ThreatMinorAttackedByPawn;
+extern int ThreatMinorAttackedByMinor;
+extern int ThreatMinorAttackedByMajor;
+extern int ThreatRookAttackedByLesser;
+extern int ThreatQueenAttackedByOne;
+extern int ThreatOverloadedPieces;
+extern int ThreatByPawnPush;
+
+#define TERM(name) { #name, (int*) &name, sizeof(name) / sizeof(int) }
+
+// Every term which the tuner is able to print, in the same order
+static WeightTerm WeightTerms[] = {
+    TERM(PawnValue), TERM(KnightValue), TERM(BishopValue),
+    TERM(RookValue), TERM(QueenValue), TERM(KingValue),
+    TERM(PawnPSQT32), TERM(KnightPSQT32), TERM(BishopPSQT32),
+    TERM(RookPSQT32), TERM(QueenPSQT32), TERM(KingPSQT32),
+    TERM(PawnCandidatePasser), TERM(PawnIsolated), TERM(PawnStacked),
+    TERM(PawnBackwards), TERM(PawnConnected32),
+    TERM(KnightOutpost), TERM(KnightBehindPawn), TERM(KnightMobility),
+    TERM(BishopPair), TERM(BishopRammedPawns), TERM(BishopOutpost),
+    TERM(BishopBehindPawn), TERM(BishopMobility),
+    TERM(RookFile), TERM(RookOnSeventh), TERM(RookMobility),
+    TERM(QueenMobility),
+    TERM(KingDefenders), TERM(KingShelter), TERM(KingStorm),
+    TERM(PassedPawn), TERM(PassedFriendlyDistance), TERM(PassedEnemyDistance),
+    TERM(PassedSafePromotionPath),
+    TERM(ThreatWeakPawn), TERM(ThreatMinorAttackedByPawn),
+    TERM(ThreatMinorAttackedByMinor), TERM(ThreatMinorAttackedByMajor),
+    TERM(ThreatRookAttackedByLesser), TERM(ThreatQueenAttackedByOne),
+    TERM(ThreatOverloadedPieces), TERM(ThreatByPawnPush),
+};
+
+#undef TERM
+
+#define NWEIGHTTERMS ((int)(sizeof(WeightTerms) / sizeof(WeightTerm)))
+
+static int *DefaultWeights; // Compiled in values, saved before the first load
+
+
+static int totalWeights() {
+
+    int total = 0;
+
+    for (int i = 0; i < NWEIGHTTERMS; i++)
+        total += WeightTerms[i].length;
+
+    return total;
+}
+
+static void copyWeights(int *buffer, int toTerms) {
+
+    // Copy between the terms and a flat buffer, in the order of WeightTerms
+    for (int i = 0, offset = 0; i < NWEIGHTTERMS; offset += WeightTerms[i++].length) {
+        int *terms = WeightTerms[i].values, bytes = sizeof(int) * WeightTerms[i].length;
+        if (toTerms) memcpy(terms, buffer + offset, bytes);
+        else         memcpy(buffer + offset, terms, bytes);
+    }
+}
+
+static char* readWeightsFile(char *path) {
+
+    long size;
+    char *buffer;
+    FILE *fin = fopen(path, "rb");
+
+    if (fin == NULL) return NULL;
+
+    fseek(fin, 0, SEEK_END);
+    size = ftell(fin);
+    fseek(fin, 0, SEEK_SET);
+
+    buffer = malloc(size + 1);
+    buffer[fread(buffer, 1, size, fin)] = '\0';
+
+    fclose(fin);
+    return buffer;
+}
+
+int loadWeights(char *path) {
+
+    char name[64], *buffer, *ptr, *end;
+    int i, j, offset, mg, eg, loaded = 0;
+    int *staged = malloc(sizeof(int) * totalWeights());
+
+    if ((buffer = readWeightsFile(path)) == NULL) {
+        writerPrintf("info string Unable to open weights file %s\n", path);
+        free(staged); return 0;
+    }
+
+    // Save the compiled in weights, so that they may be restored later
+    if (DefaultWeights == NULL) {
+        DefaultWeights = malloc(sizeof(int) * totalWeights());
+        copyWeights(DefaultWeights, 0);
+    }
+
+    // Terms missing from the file keep their current values
+    copyWeights(staged, 0);
+
+    // Each term looks like the printParameters() output from the tuner,
+    // "const int Name[A][B] = { S(mg, eg), ... };", with any dimensions
+    for (ptr = buffer; (ptr = strstr(ptr, "int ")) != NULL; ptr = end + 1) {
+
+        // Skip over words which only happen to end with "int"
+        if (ptr != buffer && !strchr(" \t\n\r", ptr[-1])) { end = ptr; continue; }
+
+        if (   sscanf(ptr + 4, " %63[A-Za-z0-9_]", name) != 1
+            || (end = strchr(ptr, ';')) == NULL) {
+            writerPrintf("info string Malformed weights file %s\n", path);
+            free(buffer); free(staged); return 0;
+        }
+
+        for (i = 0, offset = 0; i < NWEIGHTTERMS; offset += WeightTerms[i++].length)
+            if (!strcmp(name, WeightTerms[i].name)) break;
+
+        if (i == NWEIGHTTERMS) {
+            writerPrintf("info string Unknown weights term %s\n", name);
+            free(buffer); free(staged); return 0;
+        }
+
+        // Read each S(mg, eg) pair up until the end of the definition
+        for (j = 0; (ptr = strstr(ptr, "S(")) != NULL && ptr < end; ptr += 2, j++) {
+
+            if (j >= WeightTerms[i].length || sscanf(ptr, "S(%d ,%d )", &mg, &eg) != 2)
+                break;
+
+            staged[offset + j] = MakeScore(mg, eg);
+        }
+
+        if (j != WeightTerms[i].length || (ptr != NULL && ptr < end)) {
+            writerPrintf("info string Expected %d values for weights term %s\n", WeightTerms[i].length, name);
+            free(buffer); free(staged); return 0;
+        }
+
+        loaded++;
+    }
+
+    // Only apply the weights once the entire file has been accepted
+    copyWeights(staged, 1);
+    applyWeights();
+
+    free(buffer); free(staged);
+    return loaded;
+}
+
+void restoreWeights() {
+
+    if (DefaultWeights == NULL) return;
+
+    copyWeights(DefaultWeights, 1);
+    applyWeights();
+}
+
+void applyWeights() {
+
+    const int *values[] = {
+        &PawnValue, &KnightValue, &BishopValue,
+        &RookValue, &QueenValue, &KingValue,
+    };
+
+    // Material is folded into the PSQT, and used for move ordering
+    for (int piece = PAWN; piece <= KING; piece++) {
+        PieceValues[piece][MG] = ScoreMG(*values[piece]);
+        PieceValues[piece][EG] = ScoreEG(*values[piece]);
+    }
+
+    initializePSQT();
+}
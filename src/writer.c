@@ -0,0 +1,207 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "types.h"
+#include "writer.h"
+
+// All output for the interface is formatted by the calling thread into a slot
+// of a bounded lock-free queue, and then written out by a dedicated writer
+// thread. A slow reader on the other end of the pipe only ever stalls the
+// writer. Messages keep the order in which they were queued, so a bestmove
+// always follows its final info line, and precedes any later readyok
+
+static WriterSlot Slots[WRITER_SLOTS];
+static atomic_size_t Head;   // Next position to be claimed by a producer
+static size_t Tail;          // Next position to be written, writer only
+static atomic_int Sleeping, Running, Stopping;
+
+static pthread_t WriterThread;
+static pthread_mutex_t WakeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  WakeCond = PTHREAD_COND_INITIALIZER;
+
+static int slotIsFree(size_t position) {
+
+    // A slot still holding a message from an earlier lap lags behind
+    size_t seq = atomic_load_explicit(&Slots[position & (WRITER_SLOTS - 1)].sequence, memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)position >= 0;
+}
+
+static WriterSlot* claimSlot(size_t *position, size_t reserve) {
+
+    size_t pos = atomic_load_explicit(&Head, memory_order_relaxed);
+
+    while (1) {
+
+        WriterSlot *slot = &Slots[pos & (WRITER_SLOTS - 1)];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        // Leave room for the messages which are never dropped
+        if (reserve && !slotIsFree(pos + reserve)) return NULL;
+
+        // The slot is free, so race the other producers for it
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&Head, &pos, pos + 1)) {
+                *position = pos; return slot;
+            }
+        }
+
+        // Still holding a message from a full lap earlier
+        else if (diff < 0) return NULL;
+
+        // Claimed by another producer, so look at the latest position
+        else pos = atomic_load_explicit(&Head, memory_order_relaxed);
+    }
+}
+
+static void publishSlot(WriterSlot *slot, size_t position) {
+
+    atomic_store(&slot->sequence, position + 1);
+
+    // Only take the lock when the writer has gone to sleep, which it only does
+    // while the queue is empty. The lock is never held over any I/O
+    if (atomic_load(&Sleeping)) {
+        pthread_mutex_lock(&WakeLock);
+        pthread_cond_signal(&WakeCond);
+        pthread_mutex_unlock(&WakeLock);
+    }
+}
+
+static int queueOutput(int droppable, const char *format, va_list args) {
+
+    WriterSlot *slot;
+    size_t position;
+
+    // Wait for room, unless the message may be lost. Info lines from the search
+    // are dropped instead, as the interface is already far behind, and they
+    // may not use the last few slots, so that a bestmove always has room
+    while ((slot = claimSlot(&position, droppable ? WRITER_RESERVE : 0)) == NULL) {
+        if (droppable) return 0;
+        sched_yield();
+    }
+
+    vsnprintf(slot->text, WRITER_SLOT_SIZE, format, args);
+    publishSlot(slot, position);
+    return 1;
+}
+
+static void waitForOutput() {
+
+    struct timespec deadline;
+
+    pthread_mutex_lock(&WakeLock);
+    atomic_store(&Sleeping, 1);
+
+    // Check again after announcing that we sleep, so that no wakeup is lost.
+    // The timeout is only a safety net, and should never be needed
+    WriterSlot *slot = &Slots[Tail & (WRITER_SLOTS - 1)];
+    if (atomic_load(&slot->sequence) != Tail + 1 && !atomic_load(&Stopping)) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 50 * 1000000;
+        deadline.tv_sec  += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+        pthread_cond_timedwait(&WakeCond, &WakeLock, &deadline);
+    }
+
+    atomic_store(&Sleeping, 0);
+    pthread_mutex_unlock(&WakeLock);
+}
+
+static void* writeOutput(void *unused) {
+
+    (void) unused;
+
+    while (1) {
+
+        WriterSlot *slot = &Slots[Tail & (WRITER_SLOTS - 1)];
+
+        // Write everything which is ready, and only flush once caught up
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == Tail + 1) {
+            fputs(slot->text, stdout);
+            atomic_store_explicit(&slot->sequence, Tail + WRITER_SLOTS, memory_order_release);
+            Tail++; continue;
+        }
+
+        fflush(stdout);
+
+        if (atomic_load(&Stopping)) break;
+
+        waitForOutput();
+    }
+
+    return NULL;
+}
+
+void startWriter() {
+
+    for (size_t i = 0; i < WRITER_SLOTS; i++)
+        atomic_init(&Slots[i].sequence, i);
+
+    atomic_store(&Head, 0); Tail = 0;
+    atomic_store(&Stopping, 0);
+    atomic_store(&Running, 1);
+
+    pthread_create(&WriterThread, NULL, &writeOutput, NULL);
+}
+
+void stopWriter() {
+
+    if (!atomic_load(&Running)) return;
+
+    // Everything already queued is written before the writer exits
+    pthread_mutex_lock(&WakeLock);
+    atomic_store(&Stopping, 1);
+    pthread_cond_signal(&WakeCond);
+    pthread_mutex_unlock(&WakeLock);
+
+    pthread_join(WriterThread, NULL);
+    atomic_store(&Running, 0);
+}
+
+void writerPrintf(const char *format, ...) {
+
+    va_list args;
+    va_start(args, format);
+
+    // Without a writer, as for the command line tools, print directly
+    if (!atomic_load(&Running))
+        vprintf(format, args), fflush(stdout);
+    else queueOutput(0, format, args);
+
+    va_end(args);
+}
+
+void writerPrintfInfo(const char *format, ...) {
+
+    va_list args;
+    va_start(args, format);
+
+    if (!atomic_load(&Running))
+        vprintf(format, args), fflush(stdout);
+    else queueOutput(1, format, args);
+
+    va_end(args);
+}
@@ -0,0 +1,40 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdatomic.h>
+
+#include "types.h"
+
+enum {
+    WRITER_SLOTS     = 256, // Must be a power of two
+    WRITER_SLOT_SIZE = 2048,
+    WRITER_RESERVE   = 32,  // Slots kept for messages which are never dropped
+};
+
+struct WriterSlot {
+    atomic_size_t sequence;      // Free when equal to the queue position,
+    char text[WRITER_SLOT_SIZE]; // and ready to write when one greater
+};
+
+void startWriter();
+void stopWriter();
+
+void writerPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void writerPrintfInfo(const char *format, ...) __attribute__((format(printf, 1, 2)));
@@ -20,14 +20,10 @@
 #include <stdint.h>
 
 #include "castle.h"
+#include "numa.h"
 #include "types.h"
 #include "zobrist.h"
 
-uint64_t ZobristKeys[32][SQUARE_NB];
-uint64_t ZobristEnpassKeys[FILE_NB];
-uint64_t ZobristCastleKeys[0x10];
-uint64_t ZobristTurnKey;
-
 uint64_t rand64() {
 
     // http://vigna.di.unimi.it/ftp/papers/xorshift.pdf
@@ -46,37 +42,37 @@ void initZobrist() {
     // Init the main Zobrist keys for pieces and squares
     for (int pt = PAWN; pt <= KING; pt++) {
         for (int sq = 0; sq < SQUARE_NB; sq++) {
-            ZobristKeys[makePiece(pt, WHITE)][sq] = rand64();
-            ZobristKeys[makePiece(pt, BLACK)][sq] = rand64();
+            MainTables.ZobristKeys[makePiece(pt, WHITE)][sq] = rand64();
+            MainTables.ZobristKeys[makePiece(pt, BLACK)][sq] = rand64();
         }
     }
 
     // Init the enpass file Zobrist keys
     for (int f = 0; f < FILE_NB; f++)
-        ZobristEnpassKeys[f] = rand64();
+        MainTables.ZobristEnpassKeys[f] = rand64();
 
     // Init the Zobrist castle keys for each castle status
-    ZobristCastleKeys[WHITE_KING_RIGHTS ] = rand64();
-    ZobristCastleKeys[WHITE_QUEEN_RIGHTS] = rand64();
-    ZobristCastleKeys[BLACK_KING_RIGHTS ] = rand64();
-    ZobristCastleKeys[BLACK_QUEEN_RIGHTS] = rand64();
+    MainTables.ZobristCastleKeys[WHITE_KING_RIGHTS ] = rand64();
+    MainTables.ZobristCastleKeys[WHITE_QUEEN_RIGHTS] = rand64();
+    MainTables.ZobristCastleKeys[BLACK_KING_RIGHTS ] = rand64();
+    MainTables.ZobristCastleKeys[BLACK_QUEEN_RIGHTS] = rand64();
 
     // Combine the Zobrist castle keys for all possible castling rights
     for (int cr = 0; cr < 0x10; cr++) {
 
         if (cr & WHITE_KING_RIGHTS)
-            ZobristCastleKeys[cr] ^= ZobristCastleKeys[WHITE_KING_RIGHTS];
+            MainTables.ZobristCastleKeys[cr] ^= MainTables.ZobristCastleKeys[WHITE_KING_RIGHTS];
 
         if (cr & WHITE_QUEEN_RIGHTS)
-            ZobristCastleKeys[cr] ^= ZobristCastleKeys[WHITE_QUEEN_RIGHTS];
+            MainTables.ZobristCastleKeys[cr] ^= MainTables.ZobristCastleKeys[WHITE_QUEEN_RIGHTS];
 
         if (cr & BLACK_KING_RIGHTS)
-            ZobristCastleKeys[cr] ^= ZobristCastleKeys[BLACK_KING_RIGHTS];
+            MainTables.ZobristCastleKeys[cr] ^= MainTables.ZobristCastleKeys[BLACK_KING_RIGHTS];
 
         if (cr & BLACK_QUEEN_RIGHTS)
-            ZobristCastleKeys[cr] ^= ZobristCastleKeys[BLACK_QUEEN_RIGHTS];
+            MainTables.ZobristCastleKeys[cr] ^= MainTables.ZobristCastleKeys[BLACK_QUEEN_RIGHTS];
     }
 
     // Init the Zobrist key for side to move
-    ZobristTurnKey = rand64();
+    MainTables.ZobristTurnKey = rand64();
 }